@@ -1,71 +1,75 @@
 // Includes
-#include "header.hh";
+#include "grid_search.hpp"
 
+// How many expansions an anytime pass makes between checks of the clock
+#define ARA_CLOCK_CHECK_INTERVAL (256)
 
 // Defining AStar Class
-// Gets heuristic from given point to end distance
-float AStar::get_heuristic(int x_i, int y_i, int x_f, int y_f) {
-	return sqrt(pow((x_f - x_i), 2) + pow((y_f - y_i), 2));
-}
+// Integer octile distance, tightened by the ALT bounds once landmarks are set, which works with either queue
+typedef landmark_heuristic astar_heuristic;
 
 
-// When called, adds all elements to a priority queue
-void AStar::initializePriorityQueue() {
-	// Make heap is O(n) while adding 1 @ a time is O(nlogn)
-	pq.push(&node_map[0][0]);
-	vector<node_t*> node_ptrs;
-	for (int row = 0; row < rows; row++) {
-		for (int col = 0; col < cols; col++) {
-			node_ptrs.push_back(&node_map[row][col]);
-		}
+/*
+ * Starts a new resumable search from start to goal. Nodes left over from the
+ * last search go stale instead of being reset, so this is cheap enough to
+ * call every frame. Call step to make progress on the search.
+ */
+void AStar::start_search() {
+	pq.clear();
+	bq.clear();
+	int start = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	if (queue_type == QUEUE_BUCKET) {
+		begin_grid_search(grid, bq, search, astar_heuristic(goal_x, goal_y, landmarks.get()), start, goal);
+	}
+	else {
+		begin_grid_search(grid, pq, search, astar_heuristic(goal_x, goal_y, landmarks.get()), start, goal);
 	}
-	make_heap(node_ptrs.begin(), node_ptrs.end(), CNode::nodeCompare);
 }
 
-// ADT method to simplify popping min element
-node_t* AStar::pop_min() {
-	node_t* of_interest = (node_t*) pq.top();
-	pq.pop();
-	return of_interest;
+// Starts a new resumable search between a new start and goal
+void AStar::start_search(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	start_search();
 }
 
-// Performs necessary computations, stores them in node, & returns if path was found
-bool AStar::compute() {
-	bool reached_dest = false;
-
-	node_map[start_x][start_y].cost = 0;
-	node_map[start_x][start_y].heuristic = get_heuristic(start_x, start_y, goal_x, goal_y);
-
-	//initializePriorityQueue();
-
-	pq.push(&node_map[start_x][start_y]);
-
-	while (!pq.empty()) {
-		node_t* of_interest = pop_min();
-		int parent_x = of_interest->x, parent_y = of_interest->y;
+/*
+ * Expands at most max_expansions nodes of the current search and returns
+ * where it stands. Once the search has finished, further calls do nothing
+ * and return the same status, so a caller can split one plan across frames.
+ */
+search_status_t AStar::step(int max_expansions) {
+	if (queue_type == QUEUE_BUCKET) {
+		return step_grid_search<astar_heuristic, 8, octile_costs>(grid, bq, search,
+			astar_heuristic(goal_x, goal_y, landmarks.get()), max_expansions);
+	}
+	return step_grid_search<astar_heuristic, 8, octile_costs>(grid, pq, search,
+		astar_heuristic(goal_x, goal_y, landmarks.get()), max_expansions);
+}
 
-		// Checking if destination reached
-		if ((parent_x == goal_x) && (parent_y == goal_y)) {
-			reached_dest = true;
-			break;
-		}
+// Returns where the current search stands
+search_status_t AStar::get_status() {
+	return this->search.status;
+}
 
-		// Expanding neighbors
-		vector<node_t*> neighbors = NodeMap::get_neighbors(node_map, parent_x, parent_y, rows, cols);
-		for (int index = 0; index < neighbors.size(); index++) {
-			neighbors[index]->heuristic = get_heuristic(neighbors[index]->x, neighbors[index]->y, goal_x, goal_y);
-			if ((CNode::get_cost(of_interest) + COST) < CNode::get_cost(neighbors[index])) {
-				CNode::set_cost(neighbors[index], CNode::get_cost(of_interest) + COST);
-				pq.push(neighbors[index]);
-			}
-		}
-	}
+/*
+ * Returns the best path known so far: the full path once the goal has been
+ * found, otherwise the path to the expanded node closest to the goal.
+ */
+vector<tuple<int, int>> AStar::get_partial_path() {
+	return partial_grid_path(grid, search);
+}
 
-	return reached_dest;
+// Performs necessary computations, stores them in the grid, & returns if path was found
+bool AStar::compute() {
+	start_search();
+	return (step(max_cost) == SEARCH_FOUND);
 }
 
 // constructors
-AStar::AStar(bool** occ_matrix, int rows, int cols) {
+AStar::AStar(bool** occ_matrix, int rows, int cols) : grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
 	// By default, setting bottom left as start and top right corner as goal
 	start_x = 0;
 	start_y = 0;
@@ -73,22 +77,71 @@ AStar::AStar(bool** occ_matrix, int rows, int cols) {
 	goal_y = cols - 1;
 	this->rows = rows;
 	this->cols = cols;
-	node_map = NodeMap::initialize_node_map(rows, cols, occ_matrix, start_x, start_y);
+	this->epsilon = 1;
+	this->suboptimality_bound = 1;
+	this->iteration = 0;
+	this->queue_type = QUEUE_BINARY_HEAP;
+	start_search();
 }
 
-AStar::AStar(bool **occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) {
+AStar::AStar(bool **occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
 	this->start_x = start_x;
 	this->start_y = start_y;
 	this->goal_x = goal_x;
 	this->goal_y = goal_y;
 	this->rows = rows;
 	this->cols = cols;
-	node_map = NodeMap::initialize_node_map(rows, cols, occ_matrix, start_x, start_y);
+	this->epsilon = 1;
+	this->suboptimality_bound = 1;
+	this->iteration = 0;
+	this->queue_type = QUEUE_BINARY_HEAP;
+	start_search();
+}
+
+/*
+ * Selects the queue for step and generate_path and restarts the current
+ * search with it. Costs and the heuristic are integers, so both queues give
+ * the same path costs. The anytime planner always uses the binary heap.
+ */
+void AStar::set_queue_type(queue_type_t queue_type) {
+	if ((queue_type == QUEUE_BUCKET) && (this->queue_type != QUEUE_BUCKET)) {
+		bq = BucketQueue(grid.get_num_nodes());
+	}
+	this->queue_type = queue_type;
+	start_search();
+}
+
+/*
+ * Picks num_landmarks landmarks (at most MAX_LANDMARKS) on the current map
+ * and computes their cost tables, which every later search uses as an ALT
+ * heuristic; 0 drops them. Building takes one Dijkstra per landmark, so it
+ * pays off over many queries between large map changes. Occupancy updates
+ * keep the tables valid (see Landmarks).
+ */
+void AStar::set_landmarks(int num_landmarks) {
+	if (num_landmarks > 0) {
+		landmarks.reset(new Landmarks(grid, num_landmarks));
+	}
+	else {
+		landmarks.reset();
+	}
+	start_search();
 }
 
-// Returns the node map assosiated with this instance
-node_t** AStar::get_node_map() {
-	return this->node_map;
+// Returns the landmarks in use, or NULL if there are none
+Landmarks* AStar::get_landmarks() {
+	return this->landmarks.get();
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* AStar::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of nodes popped off the pq during the last search
+int AStar::get_expansions() {
+	return this->search.expansions;
 }
 
 /*
@@ -96,13 +149,150 @@ node_t** AStar::get_node_map() {
  * path exists, traces it out and returns it.
  */
 vector<tuple<int, int>> AStar::generate_path() {
+	this->path.clear();
 	bool path_exists = compute();
 	if (path_exists) {
-		this->path = NodeMap::trace_path(this->node_map, goal_x, goal_y, rows, cols);
+		this->path = grid.trace_path(grid.index(goal_x, goal_y));
 	}
 	return this->path;
 }
 
+/*
+ * Plans between a new start and goal, reusing this instance's grid and pq.
+ * Only the nodes the search reaches are reinitialized, so back to back plans
+ * cost O(expanded) rather than O(rows * cols).
+ */
+vector<tuple<int, int>> AStar::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
+
+/*
+ * One ARA* pass: expands nodes in order of g + epsilon * h until no queued key
+ * is smaller than the goal's cost. A node that improves after being expanded
+ * in this pass goes onto incons instead of being expanded again. Returns
+ * false if the deadline passes or the goal turns out to be unreachable.
+ */
+bool AStar::improve_path(steady_clock::time_point deadline) {
+	int goal = grid.index(goal_x, goal_y);
+	astar_heuristic heuristic = astar_heuristic(goal_x, goal_y, landmarks.get());
+	while (!pq.isEmpty() && ((float) grid.g[goal] > pq.top_key().k1)) {
+		// Reading the clock every expansion would cost more than the expansions
+		if (((search.expansions % ARA_CLOCK_CHECK_INTERVAL) == 0) && (steady_clock::now() >= deadline)) {
+			return false;
+		}
+
+		int of_interest = pq.pop();
+		closed[of_interest] = iteration;
+		search.expansions++;
+
+		for (neighbor_t next : grid.neighbors(of_interest)) {
+			int neighbor = next.index, new_cost = grid.g[of_interest] + next.cost;
+			grid.visit(neighbor);
+			if (new_cost < grid.g[neighbor]) {
+				if (grid.g[neighbor] == max_cost) {
+					grid.heuristic[neighbor] = heuristic(grid.row_of(neighbor), grid.col_of(neighbor));
+				}
+				grid.g[neighbor] = new_cost;
+				grid.parents[neighbor] = of_interest;
+				if (closed[neighbor] != iteration) {
+					pq.push(neighbor, { new_cost + (epsilon * grid.heuristic[neighbor]), (float) new_cost });
+				}
+				else {
+					incons.push_back(neighbor);
+				}
+			}
+		}
+	}
+
+	return (grid.g[goal] != max_cost);
+}
+
+/*
+ * Moves incons into the pq and rekeys every queued node with the current
+ * epsilon. Returns the smallest unweighted g + h among them, which is a lower
+ * bound on the optimal path cost (max_heuristic if nothing is queued).
+ */
+float AStar::reweight_open() {
+	vector<int> open = incons;
+	incons.clear();
+	while (!pq.isEmpty()) {
+		open.push_back(pq.pop());
+	}
+
+	float min_f = max_heuristic;
+	for (int node : open) {
+		float g = (float) grid.g[node], h = grid.heuristic[node];
+		min_f = min(min_f, g + h);
+		pq.push(node, { g + (epsilon * h), g });
+	}
+	return min_f;
+}
+
+/*
+ * Anytime Repairing A*. Plans with the heuristic inflated by initial_epsilon
+ * so a path comes back quickly, then lowers epsilon by epsilon_step and
+ * repairs the search (keeping its g values) for as long as the deadline
+ * allows. Returns the best path found before the deadline, or an empty path
+ * if none was. See get_suboptimality_bound for how good that path is.
+ */
+vector<tuple<int, int>> AStar::generate_path(steady_clock::time_point deadline, float initial_epsilon, float epsilon_step) {
+	this->path.clear();
+	grid.begin_search();
+	pq.clear();
+	incons.clear();
+	search.expansions = 0;
+	if (closed.size() != (size_t) grid.get_num_nodes()) {
+		closed.assign(grid.get_num_nodes(), 0);
+	}
+	epsilon = max(1.0f, initial_epsilon);
+	suboptimality_bound = max_heuristic;
+
+	int start = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	grid.visit(goal);
+	grid.visit(start);
+	grid.g[start] = 0;
+	grid.heuristic[start] = astar_heuristic(goal_x, goal_y, landmarks.get())(start_x, start_y);
+	iteration++;
+	pq.push(start, { epsilon * grid.heuristic[start], 0 });
+	search.goal = goal;
+	search.best_node = start;
+	search.best_rank = grid.heuristic[start];
+
+	while (improve_path(deadline)) {
+		this->path = grid.trace_path(goal);
+		if (epsilon <= 1) {
+			suboptimality_bound = 1;
+			break;
+		}
+
+		// Tightening epsilon, where the bound reached is epsilon or g(goal) / min(g + h), whichever is smaller
+		float prev_epsilon = epsilon;
+		epsilon = (epsilon_step > 0) ? max(1.0f, epsilon - epsilon_step) : 1;
+		float min_f = reweight_open();
+		suboptimality_bound = max(1.0f, min(prev_epsilon, (float) grid.g[goal] / min_f));
+		iteration++;
+		if ((suboptimality_bound <= 1) || (steady_clock::now() >= deadline)) {
+			break;
+		}
+	}
+
+	// The anytime queue is keyed differently, so step can't resume it (no path by the deadline reads as unreachable)
+	search.status = this->path.empty() ? SEARCH_UNREACHABLE : SEARCH_FOUND;
+	return this->path;
+}
+
+/*
+ * Returns the factor by which the last anytime path may exceed the optimal
+ * path's cost (1 means optimal, max_heuristic means no path was found).
+ */
+float AStar::get_suboptimality_bound() {
+	return this->suboptimality_bound;
+}
+
 /*
  * Given a new occupancy map, this regenerates a valid new path. Furthermore,
  * returns true if path needs to be recomputed.
@@ -123,9 +313,12 @@ bool AStar::update_occupancy_map(bool** occupancy_map) {
 	// Updating the occupancy matrix
 	for (int row = 0; row < this->rows; row++) {
 		for (int col = 0; col < this->cols; col++) {
-			CNode::initialize_node(& node_map[row][col], max_cost, occupancy_map[row][col], max_heuristic);
+			grid.set_occupancy(grid.index(row, col), occupancy_map[row][col]);
 		}
 	}
+	if (landmarks) {
+		landmarks->update_occupancy_map(occupancy_map);
+	}
 
 	return recomputePath;
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Includes
+#include "grid_search.hpp"
+
+
+// Defining BatchPlanner Class
+typedef octile_heuristic<octile_costs> batch_heuristic;
+
+// Constructor with one worker per hardware thread
+BatchPlanner::BatchPlanner(bool** occ_matrix, int rows, int cols) :
+	BatchPlanner(occ_matrix, rows, cols, (int) thread::hardware_concurrency()) {}
+
+// Constructor, which starts num_threads workers (at least one) that wait for batches
+BatchPlanner::BatchPlanner(bool** occ_matrix, int rows, int cols, int num_threads) : map(rows, cols, occ_matrix) {
+	this->rows = rows;
+	this->cols = cols;
+	this->num_threads = max(1, num_threads);
+	this->batch = NULL;
+	this->results = NULL;
+	this->next_query = 0;
+	this->batch_id = 0;
+	this->busy_workers = 0;
+	this->stopping = false;
+
+	for (int worker = 0; worker < this->num_threads; worker++) {
+		workers.push_back(thread(&BatchPlanner::run_worker, this, worker));
+	}
+}
+
+// Destructor, which lets the workers finish and joins them
+BatchPlanner::~BatchPlanner() {
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	for (thread& worker : workers) {
+		worker.join();
+	}
+}
+
+/*
+ * Body of a worker thread. The first worker searches on the map's own grid
+ * and every other worker gets a grid that shares the map's occupancy, so N
+ * workers hold N sets of search state and one map. A worker's search state
+ * is created on its own thread and lives as long as the planner, so batches
+ * don't reallocate it. For every batch, the worker takes queries off the
+ * shared counter until none are left and then reports in. A worker whose
+ * search state couldn't be allocated takes no queries and only reports in,
+ * which leaves its share of every batch to the others (worker 0 among them).
+ */
+void BatchPlanner::run_worker(int worker) {
+	NodeGrid* shared = (worker == 0) ? NULL : new NodeGrid(&map);
+	if ((shared != NULL) && (shared->g == NULL)) {
+		fprintf(stderr, "Batch planner worker %d has no search state and will take no queries.\n", worker);
+		delete shared;
+		shared = NULL;
+	}
+	bool can_search = (worker == 0) || (shared != NULL);
+	NodeGrid& grid = (shared == NULL) ? map : *shared;
+	BucketQueue queue = BucketQueue(can_search ? grid.get_num_nodes() : 0);
+	search_state_t search;
+	unsigned int seen_batch = 0;
+
+	while (true) {
+		{
+			unique_lock<mutex> guard(lock);
+			work_ready.wait(guard, [&] { return stopping || (batch_id != seen_batch); });
+			if (stopping) {
+				delete shared;
+				return;
+			}
+			seen_batch = batch_id;
+		}
+
+		// Even one look at the counter would claim a query, so a worker that can't search leaves it alone
+		int num_queries = (int) batch->size();
+		for (int query = can_search ? next_query.fetch_add(1) : num_queries; query < num_queries;
+			query = next_query.fetch_add(1)) {
+			const path_query_t& request = (*batch)[query];
+			path_result_t& result = (*results)[query];
+			auto start = high_resolution_clock::now();
+
+			queue.clear();
+			int goal = grid.index(request.goal_x, request.goal_y);
+			batch_heuristic heuristic = batch_heuristic(request.goal_x, request.goal_y);
+			begin_grid_search(grid, queue, search, heuristic, grid.index(request.start_x, request.start_y), goal);
+			if (step_grid_search<batch_heuristic, 8, octile_costs>(grid, queue, search, heuristic, max_cost) == SEARCH_FOUND) {
+				result.path = grid.trace_path(goal);
+				result.cost = grid.g[goal];
+			}
+			else {
+				result.path.clear();
+				result.cost = max_cost;
+			}
+			result.expansions = search.expansions;
+			result.worker = worker;
+			result.microseconds = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+		}
+
+		{
+			lock_guard<mutex> guard(lock);
+			busy_workers--;
+			if (busy_workers == 0) {
+				batch_done.notify_one();
+			}
+		}
+	}
+}
+
+// Returns the shared map (the first worker's search state lives in it too)
+NodeGrid* BatchPlanner::get_node_map() {
+	return &this->map;
+}
+
+// Returns the number of worker threads
+int BatchPlanner::get_num_threads() {
+	return this->num_threads;
+}
+
+/*
+ * Plans every query on the workers and returns the results in the same
+ * order as the queries. Blocks until the whole batch is done, and isn't
+ * meant to be called from more than one thread at a time.
+ */
+vector<path_result_t> BatchPlanner::plan(const vector<path_query_t>& queries) {
+	vector<path_result_t> planned(queries.size());
+	if (queries.empty()) {
+		return planned;
+	}
+
+	{
+		lock_guard<mutex> guard(lock);
+		batch = &queries;
+		results = &planned;
+		next_query = 0;
+		busy_workers = num_threads;
+		batch_id++;
+	}
+	work_ready.notify_all();
+
+	unique_lock<mutex> guard(lock);
+	batch_done.wait(guard, [&] { return busy_workers == 0; });
+	batch = NULL;
+	results = NULL;
+	return planned;
+}
+
+/*
+ * Updates the shared map. Batches don't overlap with this call since plan
+ * blocks until its batch is done, so the workers see the new occupancy from
+ * the next batch on.
+ */
+void BatchPlanner::update_occupancy_map(bool** occupancy_map) {
+	lock_guard<mutex> guard(lock);
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			map.set_occupancy(map.index(row, col), occupancy_map[row][col]);
+		}
+	}
+}
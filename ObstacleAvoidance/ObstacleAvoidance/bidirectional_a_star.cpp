@@ -0,0 +1,295 @@
+// Includes
+#include "grid_search.hpp"
+
+// Best meeting so far, packed as its cost in the high 32 bits and its node in the low 32 bits
+#define NO_MEETING ((((uint64_t) max_cost) << 32) | 0xFFFFFFFF)
+
+
+// Defining BidirectionalAStar Class
+typedef octile_heuristic<octile_costs> bidirectional_heuristic;
+
+/*
+ * Everything one direction of the search works on. Labels are the costs a
+ * direction publishes for the other one to read while both run on their own
+ * threads, each tagged with the search it belongs to.
+ */
+typedef struct search_side {
+	NodeGrid* grid;
+	BucketQueue* queue;
+	bidirectional_heuristic heuristic;
+	NodeGrid* other;
+	uint64_t* labels;
+	uint64_t* other_labels;
+	int expansions;
+} search_side_t;
+
+/*
+ * Returns the cost the other direction has reached a node with (max_cost if
+ * it hasn't). The concurrent version reads its label, which may be out of
+ * date, but a stale cost still belongs to a real path and the search only
+ * stops once no cheaper meeting is possible, so it just stops a bit later.
+ */
+template <bool concurrent>
+static inline int other_cost(search_side_t& side, int node, uint64_t search_id) {
+	if constexpr (concurrent) {
+		uint64_t label = atomic_ref<uint64_t>(side.other_labels[node]).load(memory_order_relaxed);
+		return ((label >> 32) == search_id) ? (int) (label & 0xFFFFFFFF) : max_cost;
+	}
+	else {
+		return side.other->visited(node) ? side.other->g[node] : max_cost;
+	}
+}
+
+/*
+ * Pops one node off a direction's queue and relaxes its neighbors. Every
+ * neighbor whose cost improves is checked against the other direction, and
+ * a path through it that's cheaper than the best meeting replaces it.
+ */
+template <bool concurrent, typename best_t>
+static inline void expand_side(search_side_t& side, best_t& best, uint64_t search_id) {
+	NodeGrid& grid = *side.grid;
+	int of_interest = side.queue->pop();
+	side.expansions++;
+
+	for (neighbor_t next : grid.neighbors(of_interest)) {
+		int neighbor = next.index, new_cost = grid.g[of_interest] + next.cost;
+		grid.visit(neighbor);
+		if (new_cost >= grid.g[neighbor]) {
+			continue;
+		}
+		if (grid.g[neighbor] == max_cost) {
+			grid.heuristic[neighbor] = side.heuristic(grid.row_of(neighbor), grid.col_of(neighbor));
+		}
+		grid.g[neighbor] = new_cost;
+		grid.parents[neighbor] = of_interest;
+		side.queue->push(neighbor, (int) grid.heuristic[neighbor] + new_cost);
+		if constexpr (concurrent) {
+			atomic_ref<uint64_t>(side.labels[neighbor]).store((search_id << 32) | (uint64_t) new_cost, memory_order_relaxed);
+		}
+
+		// Checking for a cheaper meeting
+		int met_cost = other_cost<concurrent>(side, neighbor, search_id);
+		if (met_cost != max_cost) {
+			uint64_t candidate = (((uint64_t) (new_cost + met_cost)) << 32) | (uint64_t) neighbor;
+			if constexpr (concurrent) {
+				uint64_t current = best.load(memory_order_relaxed);
+				while ((candidate < current) && !best.compare_exchange_weak(current, candidate, memory_order_relaxed)) {}
+			}
+			else {
+				best = min(best, candidate);
+			}
+		}
+	}
+}
+
+/*
+ * Runs one direction on its own until its queue runs dry, its smallest key
+ * reaches the best meeting's cost or the other direction has finished.
+ */
+static void run_side(search_side_t* side, atomic<uint64_t>* best, atomic<bool>* done, uint64_t search_id) {
+	while (!done->load(memory_order_relaxed) && !side->queue->isEmpty() &&
+		((uint64_t) side->queue->top_key() < (best->load(memory_order_relaxed) >> 32))) {
+		expand_side<true>(*side, *best, search_id);
+	}
+	done->store(true, memory_order_relaxed);
+}
+
+
+// Constructors
+BidirectionalAStar::BidirectionalAStar(bool** occ_matrix, int rows, int cols) :
+	BidirectionalAStar(occ_matrix, rows, cols, 0, 0, rows - 1, cols - 1) {}
+
+BidirectionalAStar::BidirectionalAStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	forward(rows, cols, occ_matrix), backward(rows, cols, occ_matrix),
+	forward_queue(forward.get_num_nodes()), backward_queue(backward.get_num_nodes()) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	this->rows = rows;
+	this->cols = cols;
+	this->expansions = 0;
+	this->meeting = -1;
+	this->threaded = false;
+	this->search_id = 0;
+}
+
+// Seeds the forward search at the start and the backward search at the goal
+void BidirectionalAStar::begin_search() {
+	int start = forward.index(start_x, start_y), goal = backward.index(goal_x, goal_y);
+	forward.begin_search();
+	backward.begin_search();
+	forward_queue.clear();
+	backward_queue.clear();
+	expansions = 0;
+	meeting = -1;
+
+	forward.visit(start);
+	forward.g[start] = 0;
+	forward.heuristic[start] = bidirectional_heuristic(goal_x, goal_y)(start_x, start_y);
+	forward_queue.push(start, (int) forward.heuristic[start]);
+
+	backward.visit(goal);
+	backward.g[goal] = 0;
+	backward.heuristic[goal] = bidirectional_heuristic(start_x, start_y)(goal_x, goal_y);
+	backward_queue.push(goal, (int) backward.heuristic[goal]);
+}
+
+/*
+ * Alternates between the directions and returns whether a path was found.
+ * Until they meet, the smaller frontier is expanded to keep them balanced.
+ * After that the search only has to prove the meeting optimal, which takes
+ * one frontier's smallest key reaching its cost, so the frontier closer to
+ * getting there is expanded. The node where the cheapest path crosses from
+ * one search to the other is kept in meeting.
+ */
+bool BidirectionalAStar::compute() {
+	begin_search();
+	int start = forward.index(start_x, start_y), goal = backward.index(goal_x, goal_y);
+	if (start == goal) {
+		meeting = start;
+		return true;
+	}
+
+	search_side_t forward_side = { &forward, &forward_queue, bidirectional_heuristic(goal_x, goal_y), &backward, NULL, NULL, 0 };
+	search_side_t backward_side = { &backward, &backward_queue, bidirectional_heuristic(start_x, start_y), &forward, NULL, NULL, 0 };
+	uint64_t best = NO_MEETING;
+	while (!forward_queue.isEmpty() && !backward_queue.isEmpty() &&
+		((uint64_t) max(forward_queue.top_key(), backward_queue.top_key()) < (best >> 32))) {
+		bool expand_forward = (best == NO_MEETING) ? (forward_queue.get_size() <= backward_queue.get_size()) :
+			(forward_queue.top_key() >= backward_queue.top_key());
+		if (expand_forward) {
+			expand_side<false>(forward_side, best, 0);
+		}
+		else {
+			expand_side<false>(backward_side, best, 0);
+		}
+	}
+
+	expansions = forward_side.expansions + backward_side.expansions;
+	if (best == NO_MEETING) {
+		return false;
+	}
+	meeting = (int) (best & 0xFFFFFFFF);
+	return true;
+}
+
+/*
+ * Same search with the backward direction on a second thread. Each thread
+ * only touches its own grid and queue; the other direction's costs are read
+ * from its labels and the best meeting is shared through an atomic. Whichever
+ * direction finishes first stops the other one.
+ */
+bool BidirectionalAStar::compute_threaded() {
+	begin_search();
+	int start = forward.index(start_x, start_y), goal = backward.index(goal_x, goal_y);
+	if (start == goal) {
+		meeting = start;
+		return true;
+	}
+
+	// Labels from earlier searches are told apart by the search id, so they're only cleared when it wraps
+	if (forward_labels.size() != (size_t) forward.get_num_nodes()) {
+		forward_labels.assign(forward.get_num_nodes(), 0);
+		backward_labels.assign(backward.get_num_nodes(), 0);
+	}
+	search_id++;
+	if (search_id == 0) {
+		fill(forward_labels.begin(), forward_labels.end(), 0);
+		fill(backward_labels.begin(), backward_labels.end(), 0);
+		search_id = 1;
+	}
+	forward_labels[start] = ((uint64_t) search_id) << 32;
+	backward_labels[goal] = ((uint64_t) search_id) << 32;
+
+	search_side_t forward_side = { &forward, &forward_queue, bidirectional_heuristic(goal_x, goal_y), &backward,
+		forward_labels.data(), backward_labels.data(), 0 };
+	search_side_t backward_side = { &backward, &backward_queue, bidirectional_heuristic(start_x, start_y), &forward,
+		backward_labels.data(), forward_labels.data(), 0 };
+	atomic<uint64_t> best(NO_MEETING);
+	atomic<bool> done(false);
+
+	thread backward_thread(run_side, &backward_side, &best, &done, (uint64_t) search_id);
+	run_side(&forward_side, &best, &done, (uint64_t) search_id);
+	backward_thread.join();
+
+	expansions = forward_side.expansions + backward_side.expansions;
+	if (best.load() == NO_MEETING) {
+		return false;
+	}
+	meeting = (int) (best.load() & 0xFFFFFFFF);
+	return true;
+}
+
+/*
+ * Joins the forward path from the start to the meeting node with the
+ * backward search's parents from there to the goal, which point towards the
+ * goal since that search started there.
+ */
+vector<tuple<int, int>> BidirectionalAStar::stitch_path() {
+	vector<tuple<int, int>> stitched = forward.trace_path(meeting);
+	for (int node = backward.parents[meeting]; node != -1; node = backward.parents[node]) {
+		stitched.push_back(make_tuple(backward.row_of(node), backward.col_of(node)));
+	}
+	return stitched;
+}
+
+// Returns the forward search's node grid (the backward one has the same occupancy)
+NodeGrid* BidirectionalAStar::get_node_map() {
+	return &this->forward;
+}
+
+// Returns the number of nodes expanded by both directions during the last search
+int BidirectionalAStar::get_expansions() {
+	return this->expansions;
+}
+
+/*
+ * Runs the backward search on its own thread from now on. Starting a thread
+ * costs tens of microseconds, so this only pays off on long queries.
+ */
+void BidirectionalAStar::set_threaded(bool threaded) {
+	this->threaded = threaded;
+}
+
+// Searches from both ends and returns the stitched path, which is empty if there's none
+vector<tuple<int, int>> BidirectionalAStar::generate_path() {
+	this->path.clear();
+	bool path_exists = threaded ? compute_threaded() : compute();
+	if (path_exists) {
+		this->path = stitch_path();
+	}
+	return this->path;
+}
+
+// Plans between a new start and goal, reusing this instance's grids and queues
+vector<tuple<int, int>> BidirectionalAStar::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
+
+/*
+ * Given a new occupancy map, updates both directions' grids. Returns true if
+ * the current path is blocked (or there is none) and needs to be recomputed.
+ */
+bool BidirectionalAStar::update_occupancy_map(bool** occupancy_map) {
+	bool recomputePath = (this->path.size() == 0);
+	for (tuple<int, int> step : path) {
+		if (occupancy_map[get<0>(step)][get<1>(step)] == true) {
+			recomputePath = true;
+			break;
+		}
+	}
+
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			forward.set_occupancy(forward.index(row, col), occupancy_map[row][col]);
+			backward.set_occupancy(backward.index(row, col), occupancy_map[row][col]);
+		}
+	}
+
+	return recomputePath;
+}
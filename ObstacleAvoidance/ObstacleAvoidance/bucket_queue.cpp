@@ -0,0 +1,275 @@
+// Imports
+#include "header.hh"
+
+
+// Ring size a new queue starts with (always a power of 2)
+#define INITIAL_BUCKETS (64)
+
+// Adds an index to the front of the bucket for its key
+inline void BucketQueue::link(int index, int key) {
+	int bucket = key & (numBuckets - 1);
+	keys[index] = key;
+	prev[index] = -1;
+	next[index] = heads[bucket];
+	if (heads[bucket] != -1) {
+		prev[heads[bucket]] = index;
+	}
+	heads[bucket] = index;
+}
+
+// Takes a queued index out of its bucket
+inline void BucketQueue::unlink(int index) {
+	if (prev[index] != -1) {
+		next[prev[index]] = next[index];
+	}
+	else {
+		heads[keys[index] & (numBuckets - 1)] = next[index];
+	}
+	if (next[index] != -1) {
+		prev[next[index]] = prev[index];
+	}
+	keys[index] = -1;
+}
+
+/*
+ * Moves the cursor forward to the first non-empty bucket and returns it. Keys
+ * never go below the cursor, so this is amortized O(1). The queue must not be
+ * empty.
+ */
+inline int BucketQueue::findBucket() {
+	while (heads[cursor & (numBuckets - 1)] == -1) {
+		cursor++;
+	}
+	return cursor & (numBuckets - 1);
+}
+
+// Grows the per-index arrays so that index can be queued
+void BucketQueue::reserveIndex(int index) {
+	int newNumIndices = (numIndices > 10) ? numIndices : 10;
+	while (newNumIndices <= index) {
+		newNumIndices *= 2;
+	}
+
+	this->next = (int*)realloc((void*)this->next, sizeof(int) * newNumIndices);
+	this->prev = (int*)realloc((void*)this->prev, sizeof(int) * newNumIndices);
+	this->keys = (int*)realloc((void*)this->keys, sizeof(int) * newNumIndices);
+	for (int slot = numIndices; slot < newNumIndices; slot++) {
+		this->keys[slot] = -1;
+	}
+	this->numIndices = newNumIndices;
+}
+
+/*
+ * Grows the ring so it spans at least span + 1 consecutive keys and relinks
+ * every queued index into its new bucket.
+ */
+void BucketQueue::resize(int span) {
+	int newNumBuckets = numBuckets;
+	while (newNumBuckets <= span) {
+		newNumBuckets *= 2;
+	}
+
+	// Collecting the queued indices before the buckets are rebuilt
+	vector<int> queued;
+	queued.reserve(size);
+	for (int bucket = 0; bucket < numBuckets; bucket++) {
+		for (int index = heads[bucket]; index != -1; index = next[index]) {
+			queued.push_back(index);
+		}
+	}
+
+	this->heads = (int*)realloc((void*)this->heads, sizeof(int) * newNumBuckets);
+	for (int bucket = 0; bucket < newNumBuckets; bucket++) {
+		this->heads[bucket] = -1;
+	}
+	this->numBuckets = newNumBuckets;
+	for (int index : queued) {
+		link(index, keys[index]);
+	}
+}
+
+// Constructor if no initial elements
+BucketQueue::BucketQueue() {
+	this->size = 0;
+	this->numIndices = 0;
+	this->numBuckets = INITIAL_BUCKETS;
+	this->cursor = 0;
+	this->maxKey = 0;
+	this->heads = (int*)malloc(sizeof(int) * this->numBuckets);
+	for (int bucket = 0; bucket < numBuckets; bucket++) {
+		this->heads[bucket] = -1;
+	}
+	this->next = NULL;
+	this->prev = NULL;
+	this->keys = NULL;
+}
+
+// Constructor for a queue over node indices 0 to num_indices - 1, which never reallocates its per-index arrays
+BucketQueue::BucketQueue(int num_indices) : BucketQueue() {
+	if (num_indices > 0) {
+		reserveIndex(num_indices - 1);
+	}
+}
+
+// Copy constructor
+BucketQueue::BucketQueue(const BucketQueue& other) {
+	this->size = other.size;
+	this->numIndices = other.numIndices;
+	this->numBuckets = other.numBuckets;
+	this->cursor = other.cursor;
+	this->maxKey = other.maxKey;
+	this->heads = (int*)malloc(sizeof(int) * this->numBuckets);
+	this->next = (int*)malloc(sizeof(int) * this->numIndices);
+	this->prev = (int*)malloc(sizeof(int) * this->numIndices);
+	this->keys = (int*)malloc(sizeof(int) * this->numIndices);
+	memcpy(this->heads, other.heads, sizeof(int) * this->numBuckets);
+	memcpy(this->next, other.next, sizeof(int) * this->numIndices);
+	memcpy(this->prev, other.prev, sizeof(int) * this->numIndices);
+	memcpy(this->keys, other.keys, sizeof(int) * this->numIndices);
+}
+
+// Copy assignment
+BucketQueue& BucketQueue::operator=(const BucketQueue& other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	free(this->heads);
+	free(this->next);
+	free(this->prev);
+	free(this->keys);
+	this->size = other.size;
+	this->numIndices = other.numIndices;
+	this->numBuckets = other.numBuckets;
+	this->cursor = other.cursor;
+	this->maxKey = other.maxKey;
+	this->heads = (int*)malloc(sizeof(int) * this->numBuckets);
+	this->next = (int*)malloc(sizeof(int) * this->numIndices);
+	this->prev = (int*)malloc(sizeof(int) * this->numIndices);
+	this->keys = (int*)malloc(sizeof(int) * this->numIndices);
+	memcpy(this->heads, other.heads, sizeof(int) * this->numBuckets);
+	memcpy(this->next, other.next, sizeof(int) * this->numIndices);
+	memcpy(this->prev, other.prev, sizeof(int) * this->numIndices);
+	memcpy(this->keys, other.keys, sizeof(int) * this->numIndices);
+	return *this;
+}
+
+// Destructor
+BucketQueue::~BucketQueue() {
+	free(this->heads);
+	free(this->next);
+	free(this->prev);
+	free(this->keys);
+	this->heads = NULL;
+	this->next = NULL;
+	this->prev = NULL;
+	this->keys = NULL;
+}
+
+// Returns whether the queue is empty
+bool BucketQueue::isEmpty() {
+	return (this->size == 0);
+}
+
+/*
+ * Adds an index with a non-negative key (if it's already queued, it's moved
+ * to the new key instead). Keys below the smallest queued one are allowed, but
+ * if they stretch the queued keys past the ring, the ring is grown.
+ */
+void BucketQueue::push(int index, int key) {
+	if (index >= numIndices) {
+		reserveIndex(index);
+	}
+	if (keys[index] != -1) {
+		unlink(index);
+		size--;
+	}
+
+	if (size == 0) {
+		cursor = key;
+		maxKey = key;
+	}
+	else if (key < cursor) {
+		if (maxKey - key >= numBuckets) {
+			resize(maxKey - key);
+		}
+		cursor = key;
+	}
+	else if (key - cursor >= numBuckets) {
+		resize(key - cursor);
+	}
+	maxKey = max(maxKey, key);
+
+	link(index, key);
+	size++;
+}
+
+// Adds an index keyed by the (integer) first part of a pq key, so planners can use either queue
+void BucketQueue::push(int index, pq_key_t key) {
+	push(index, (int) key.k1);
+}
+
+// Removes and returns an index with the smallest key (-1 if empty)
+int BucketQueue::pop() {
+	if (size == 0) {
+		return -1;
+	}
+	int index = heads[findBucket()];
+	unlink(index);
+	size--;
+	return index;
+}
+
+// Returns an index with the smallest key without removing it (-1 if empty)
+int BucketQueue::top() {
+	if (size == 0) {
+		return -1;
+	}
+	return heads[findBucket()];
+}
+
+// Returns the smallest key (-1 if empty)
+int BucketQueue::top_key() {
+	if (size == 0) {
+		return -1;
+	}
+	return keys[heads[findBucket()]];
+}
+
+// Returns whether an index is queued
+bool BucketQueue::contains(int index) {
+	return (index >= 0) && (index < numIndices) && (keys[index] != -1);
+}
+
+// Removes an index if it's queued, returning whether it was
+bool BucketQueue::remove(int index) {
+	if (!contains(index)) {
+		return false;
+	}
+	unlink(index);
+	size--;
+	return true;
+}
+
+// Lowers the key of a queued index
+void BucketQueue::decrease_key(int index, pq_key_t key) {
+	if (contains(index)) {
+		push(index, key);
+	}
+}
+
+// Removes every element from the queue, keeping the allocated space
+void BucketQueue::clear() {
+	for (int bucket = 0; (bucket < numBuckets) && (size > 0); bucket++) {
+		for (int index = heads[bucket]; index != -1; index = next[index]) {
+			keys[index] = -1;
+			size--;
+		}
+		heads[bucket] = -1;
+	}
+	size = 0;
+}
+
+int BucketQueue::get_size() {
+	return this->size;
+}
@@ -3,49 +3,180 @@
 
 
 // Defining DStar Class
-// Gets heuristic from given point to end distance
+// Gets the octile distance between 2 points, which never overestimates the cost of moving between them
 float DStar::get_heuristic(int x_i, int y_i, int x_f, int y_f) {
-	return sqrt(pow((x_f - x_i), 2) + pow((y_f - y_i), 2));
+	int d_x = abs(x_f - x_i), d_y = abs(y_f - y_i);
+	int diagonals = min(d_x, d_y);
+	return (float) ((DIAGONAL_COST * diagonals) + (STRAIGHT_COST * (max(d_x, d_y) - diagonals)));
 }
 
-// Performs necessary computations, stores them in node, & returns if path was found
-bool DStar::compute() {
-	bool reached_dest = false;
+// Returns g of a node, which is stored in the grid's cost (max_rhs if infinite)
+float DStar::get_g(int node) {
+	int cost = grid.g[node];
+	return (cost == max_cost) ? max_rhs : (float) cost;
+}
+
+// Sets g of a node
+void DStar::set_g(int node, float g) {
+	grid.g[node] = (g >= max_rhs) ? max_cost : (int) g;
+}
+
+/*
+ * Two-part D* Lite key: [min(g, rhs) + h(start, node) + km, min(g, rhs)].
+ * km grows each time the start moves so keys already in the pq stay valid
+ * lower bounds without being recomputed.
+ */
+pq_key_t DStar::calculate_key(int node) {
+	float min_g = min(get_g(node), grid.rhs[node]);
+	if (min_g >= max_rhs) {
+		return { max_rhs, max_rhs };
+	}
+	return { min_g + get_heuristic(start_x, start_y, grid.row_of(node), grid.col_of(node)) + km, min_g };
+}
+
+// Returns the best cost to the goal through any free neighbor of the node
+float DStar::lookahead_cost(int node) {
+	if (grid.get_occupancy(node)) {
+		return max_rhs;
+	}
 
-	node_map[start_x][start_y].cost = 0;
-	node_map[start_x][start_y].heuristic = get_heuristic(start_x, start_y, goal_x, goal_y);
+	float min_rhs = max_rhs;
+	for (neighbor_t neighbor : grid.neighbors(node)) {
+		float neighbor_g = get_g(neighbor.index);
+		if ((neighbor_g < max_rhs) && (neighbor_g + neighbor.cost < min_rhs)) {
+			min_rhs = neighbor_g + neighbor.cost;
+		}
+	}
+	return min_rhs;
+}
 
-	//initializePriorityQueue();
+// Recomputes rhs of a node and (re)queues it only if it's inconsistent
+void DStar::update_vertex(int node) {
+	if (node != grid.index(goal_x, goal_y)) {
+		grid.rhs[node] = lookahead_cost(node);
+	}
 
-	pq.push(&node_map[start_x][start_y]);
+	if (get_g(node) != grid.rhs[node]) {
+		pq.push(node, calculate_key(node));
+	}
+	else {
+		pq.remove(node);
+	}
+}
 
-	while (!pq.isEmpty()) {
-		node_t* of_interest = pq.pop();
-		int parent_x = of_interest->x, parent_y = of_interest->y;
+// Seeds the search at the goal
+void DStar::initialize() {
+	km = 0;
+	int goal = grid.index(goal_x, goal_y);
+	grid.rhs[goal] = 0;
+	pq.push(goal, calculate_key(goal));
+	initialized = true;
+}
 
-		// Checking if destination reached
-		if ((parent_x == goal_x) && (parent_y == goal_y)) {
-			reached_dest = true;
-			break;
+/*
+ * Expands at most max_expansions inconsistent nodes and returns where the
+ * search stands. The search is found once the start is consistent, and stays
+ * that way until update_start or update_occupancy gives it more to repair.
+ */
+search_status_t DStar::step(int max_expansions) {
+	if (!initialized) {
+		initialize();
+	}
+	if (status != SEARCH_IN_PROGRESS) {
+		return status;
+	}
+
+	int start = grid.index(start_x, start_y);
+	for (int budget = max_expansions; budget > 0; budget--) {
+		if (pq.isEmpty() ||
+			!(NodePriorityQueue::keyLess(pq.top_key(), calculate_key(start)) || (grid.rhs[start] > get_g(start)))) {
+			// The start itself may stay queued (overconsistent), but its rhs is already exact
+			status = (grid.rhs[start] < max_rhs) ? SEARCH_FOUND : SEARCH_UNREACHABLE;
+			return status;
 		}
 
-		// Expanding neighbors
-		vector<node_t*> neighbors = NodeMap::get_neighbors(node_map, parent_x, parent_y, rows, cols);
-		for (int index = 0; index < neighbors.size(); index++) {
-			neighbors[index]->heuristic = get_heuristic(neighbors[index]->x, neighbors[index]->y, goal_x, goal_y);
-			if ((CNode::get_cost(of_interest) + COST) < CNode::get_cost(neighbors[index])) {
-				CNode::set_cost(neighbors[index], CNode::get_cost(of_interest) + COST);
-				neighbors[index]->rhs = CNode::get_cost(of_interest) + COST;
-				pq.push(neighbors[index]);
+		int of_interest = pq.top();
+		pq_key_t old_key = pq.top_key();
+		pq_key_t new_key = calculate_key(of_interest);
+		expansions++;
+
+		// Key is outdated because the start moved
+		if (NodePriorityQueue::keyLess(old_key, new_key)) {
+			pq.update_key(of_interest, new_key);
+			continue;
+		}
+
+		if (get_g(of_interest) > grid.rhs[of_interest]) {
+			// Overconsistent, so the node's cost can be lowered
+			set_g(of_interest, grid.rhs[of_interest]);
+			pq.remove(of_interest);
+		}
+		else {
+			// Underconsistent, so the node and everything routed through it must be redone
+			set_g(of_interest, max_rhs);
+			update_vertex(of_interest);
+		}
+		for (neighbor_t neighbor : grid.neighbors(of_interest)) {
+			update_vertex(neighbor.index);
+		}
+	}
+
+	return status;
+}
+
+// Returns where the search stands
+search_status_t DStar::get_status() {
+	return this->status;
+}
+
+// Expands inconsistent nodes until the start is consistent, & returns if path was found
+bool DStar::compute() {
+	return (step(max_cost) == SEARCH_FOUND);
+}
+
+/*
+ * Follows the cheapest successor from the start down to the goal. If the
+ * descent gets stuck, the path is cleared unless keep_prefix is set, in which
+ * case the steps taken so far are returned.
+ */
+vector<tuple<int, int>> DStar::descend(bool keep_prefix) {
+	vector<tuple<int, int>> path;
+	int current = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	while ((current != goal) && (path.size() < (size_t) rows * cols)) {
+		int next = -1;
+		float next_cost = max_rhs;
+		for (neighbor_t neighbor : grid.neighbors(current)) {
+			float neighbor_g = get_g(neighbor.index);
+			if ((neighbor_g < max_rhs) && (neighbor_g + neighbor.cost < next_cost)) {
+				next = neighbor.index;
+				next_cost = neighbor_g + neighbor.cost;
+			}
+		}
+		if (next == -1) {
+			if (!keep_prefix) {
+				path.clear();
 			}
+			break;
 		}
+		current = next;
+		path.push_back(make_tuple(grid.row_of(current), grid.col_of(current)));
 	}
 
-	return reached_dest;
+	return path;
+}
+
+/*
+ * Returns the best path known so far by descending the current cost-to-goal
+ * values from the start. While a repair is in progress this is usually the
+ * previous path, possibly cut short where the repair has reached it.
+ */
+vector<tuple<int, int>> DStar::get_partial_path() {
+	return descend(true);
 }
 
 // constructors
-DStar::DStar(bool** occ_matrix, int rows, int cols) {
+DStar::DStar(bool** occ_matrix, int rows, int cols) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
 	// By default, setting bottom left as start and top right corner as goal
 	start_x = 0;
 	start_y = 0;
@@ -53,104 +184,101 @@ DStar::DStar(bool** occ_matrix, int rows, int cols) {
 	goal_y = cols - 1;
 	this->rows = rows;
 	this->cols = cols;
-	this->pq = NodePriorityQueue();
-	node_map = NodeMap::initialize_node_map(rows, cols, occ_matrix, start_x, start_y);
+	this->km = 0;
+	this->initialized = false;
+	this->expansions = 0;
+	this->status = SEARCH_IN_PROGRESS;
+
+	// D* Lite keeps its values between searches, so it doesn't use lazy resets
+	grid.reset();
 }
 
-DStar::DStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) {
+DStar::DStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
 	this->start_x = start_x;
 	this->start_y = start_y;
 	this->goal_x = goal_x;
 	this->goal_y = goal_y;
 	this->rows = rows;
 	this->cols = cols;
-	this->pq = NodePriorityQueue();
-	node_map = NodeMap::initialize_node_map(rows, cols, occ_matrix, start_x, start_y);
+	this->km = 0;
+	this->initialized = false;
+	this->expansions = 0;
+	this->status = SEARCH_IN_PROGRESS;
+
+	// D* Lite keeps its values between searches, so it doesn't use lazy resets
+	grid.reset();
 }
 
-// Returns the node map assosiated with this instance
-node_t** DStar::get_node_map() {
-	return this->node_map;
+// Returns the node grid assosiated with this instance
+NodeGrid* DStar::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of nodes expanded since this instance was created
+int DStar::get_expansions() {
+	return this->expansions;
 }
 
 /*
- * Heuristically computes all nodes' cost and heuristic distance and if
- * path exists, traces it out and returns it.
+ * Repairs the search from the current state and if a path exists, traces it
+ * out and returns it. The first call does the full search; later calls only
+ * redo the work invalidated by update_start and update_occupancy. The path
+ * runs start --> finish, excluding the start like NodeGrid::trace_path.
  */
 vector<tuple<int, int>> DStar::generate_path() {
-	NodeMap::print_occupancy_matrix(this->node_map, rows, cols);
-	bool path_exists = compute();
 	vector<tuple<int, int>> path;
-	if (path_exists) {
-		path = NodeMap::trace_path(this->node_map, goal_x, goal_y, rows, cols);
+	if (!compute()) {
+		return path;
 	}
-	return path;
+	return descend(false);
 }
 
-float min(float i, float j) {
-	return (i < j) ? i : j;
+// Moves the start, which only shifts the key offset rather than invalidating the search
+void DStar::update_start(int start_x, int start_y) {
+	km += get_heuristic(this->start_x, this->start_y, start_x, start_y);
+	this->start_x = start_x;
+	this->start_y = start_y;
+	status = SEARCH_IN_PROGRESS;
 }
 
+// Changes the occupancy of a single cell and repairs the cell and its neighbors
+void DStar::update_occupancy(int row, int col, bool occupied) {
+	int changed = grid.index(row, col);
+	if (grid.get_occupancy(changed) == occupied) {
+		return;
+	}
+	grid.set_occupancy(changed, occupied);
+	if (!initialized) {
+		return;
+	}
 
-// Updates the occupancy map
-void DStar::update_occupancy_map(bool** occupancy_map) {
-	// Updating the occupancy matrix
-	for (int row = 0; row < this->rows; row++) {
-		for (int col = 0; col < this->cols; col++) {
-			if (CNode::get_occupancy(&node_map[row][col]) != occupancy_map[row][col]) {
-				CNode::set_occupancy(&node_map[row][col], occupancy_map[row][col]);
-				if (occupancy_map[row][col] = 1) {
-					node_map[row][col].rhs = max_rhs;
-				}
-				else {
-					vector<node_t*> neighbors = NodeMap::get_neighbors(node_map, row, col, rows, cols);
-					float min_rhs = max_rhs;
-					for (node_t* neighbor : neighbors) {
-						if ((neighbor->cost + COST) < min_rhs) {
-							min_rhs = neighbor->cost + COST;
-						}
-					}
-					node_map[row][col].rhs = min_rhs;
-				}
-
-				// Adding to priority queue
-				pq.push(&node_map[row][col]);
+	status = SEARCH_IN_PROGRESS;
+	update_vertex(changed);
+	for (int d_row = -1; d_row <= 1; d_row++) {
+		for (int d_col = -1; d_col <= 1; d_col++) {
+			if (((d_row != 0) || (d_col != 0)) &&
+				!grid.outOfBounds(row + d_row, col + d_col)) {
+				update_vertex(grid.index(row + d_row, col + d_col));
 			}
 		}
 	}
+}
 
-	// Expanding on all elements in the pq
-	node_t* goal_node = &node_map[goal_x][goal_y];
-	while (!pq.isEmpty()) {
-		node_t* toExpand = pq.pop();
-		// Nodes in pq are no longer worth expanding on
-		if ((goal_node->rhs == CNode::get_cost(goal_node)) &&
-			(min(toExpand->rhs, CNode::get_cost(toExpand)) + toExpand->heuristic >= CNode::get_cost(goal_node))) {
-			break;
-		}
-
-
-		if (toExpand->rhs < CNode::get_cost(toExpand)) {
-			CNode::set_cost(toExpand, toExpand->rhs);
-		}
-		else if (toExpand->rhs > CNode::get_cost(toExpand)) {
-			CNode::set_cost(toExpand, max_cost);
-		}
-
-		vector<node_t*> neighbors = NodeMap::get_neighbors(node_map, toExpand->x, toExpand->y, rows, cols);
-		for (node_t* neighbor : neighbors) {
-			toExpand->rhs = CNode::get_cost(toExpand) + COST;
-			pq.push(toExpand);
+/*
+ * Updates the occupancy map. Comparing against the new map is a full scan, but
+ * only cells whose occupancy changed are repaired. Callers that already know
+ * which cells changed should use update_occupancy directly.
+ */
+void DStar::update_occupancy_map(bool** occupancy_map) {
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			update_occupancy(row, col, occupancy_map[row][col]);
 		}
 	}
 }
 
 // To do:
 /*
- * 1) Make diaganols have greater cost. Create a isDiag function
- * 2) Take into account incoming direction as that has real world costs
- * 3) Have custom priority queue function have 2 keys
- * 5) Create a custom 2 key comaprator function
- * 6) Give pq functionality to check existence of element in pq
- * 7) Give pq functionality to remove by element
- */
\ No newline at end of file
+ * 1) Take into account incoming direction as that has real world costs
+ */
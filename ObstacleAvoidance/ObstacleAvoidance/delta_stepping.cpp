@@ -0,0 +1,212 @@
+// Includes
+#include "header.hh"
+#include <barrier>
+
+// Default bucket width, which makes every move light
+#define DEFAULT_DELTA (DIAGONAL_COST)
+
+
+// Defining DeltaStepping Class
+// What the threads do between two barriers
+typedef enum delta_phase {
+	PHASE_LIGHT,
+	PHASE_HEAVY,
+	PHASE_DONE
+} delta_phase_t;
+
+// Lowers a node's cost if new_cost is an improvement and returns whether it was, safely against other threads
+static inline bool lower_cost(int* g, int node, int new_cost) {
+	atomic_ref<int> cost(g[node]);
+	int current = cost.load(memory_order_relaxed);
+	while (new_cost < current) {
+		if (cost.compare_exchange_weak(current, new_cost, memory_order_relaxed)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Constructor with one thread per hardware thread and the default bucket width
+DeltaStepping::DeltaStepping(bool** occ_matrix, int rows, int cols, int source_x, int source_y) :
+	DeltaStepping(occ_matrix, rows, cols, source_x, source_y, (int) thread::hardware_concurrency(), DEFAULT_DELTA) {}
+
+// Constructor, which computes the costs from the source right away
+DeltaStepping::DeltaStepping(bool** occ_matrix, int rows, int cols, int source_x, int source_y, int num_threads, int delta) :
+	grid(rows, cols, occ_matrix) {
+	this->rows = rows;
+	this->cols = cols;
+	this->source_x = source_x;
+	this->source_y = source_y;
+	this->num_threads = max(1, num_threads);
+	this->delta = max(1, delta);
+	this->phases = 0;
+	compute();
+}
+
+/*
+ * Runs the search on num_threads threads that meet at a barrier after every
+ * phase. Each thread takes an even slice of the frontier and files the
+ * nodes it improves into its own buckets, so the only shared writes are the
+ * costs themselves. Between phases, the barrier's completion step (run by
+ * one thread while the rest wait) gathers the next frontier from every
+ * thread's buckets and decides what comes next.
+ */
+void DeltaStepping::compute() {
+	int* g = grid.g;
+	fill(g, g + grid.get_num_nodes(), max_cost);
+	phases = 0;
+	int source = grid.index(source_x, source_y);
+	g[source] = 0;
+
+	// Moves up to DIAGONAL_COST, so with a wide enough bucket there are no heavy moves to make
+	bool has_heavy = (delta < DIAGONAL_COST);
+	vector<vector<vector<int>>> buckets(num_threads);
+	vector<vector<int>> settled(num_threads);
+	vector<int> frontier = { source };
+	size_t current = 0;
+	delta_phase_t phase = PHASE_LIGHT;
+
+	// Gathers bucket index from every thread into the frontier, freeing the buckets' memory
+	auto gather = [&](size_t index) {
+		frontier.clear();
+		for (vector<vector<int>>& own : buckets) {
+			if (index < own.size()) {
+				frontier.insert(frontier.end(), own[index].begin(), own[index].end());
+				vector<int>().swap(own[index]);
+			}
+		}
+	};
+
+	// Moves on to the lowest non-empty bucket above the current one, or finishes if there's none
+	auto advance = [&]() {
+		size_t num_buckets = 0;
+		for (vector<vector<int>>& own : buckets) {
+			num_buckets = max(num_buckets, own.size());
+		}
+		for (size_t index = current + 1; index < num_buckets; index++) {
+			gather(index);
+			if (!frontier.empty()) {
+				current = index;
+				phase = PHASE_LIGHT;
+				return;
+			}
+		}
+		phase = PHASE_DONE;
+	};
+
+	auto next_phase = [&]() noexcept {
+		phases++;
+		if (phase == PHASE_LIGHT) {
+			// The bucket is done once light moves stop refilling it
+			gather(current);
+			if (frontier.empty()) {
+				if (has_heavy) {
+					phase = PHASE_HEAVY;
+				}
+				else {
+					advance();
+				}
+			}
+		}
+		else {
+			advance();
+		}
+	};
+	barrier sync(num_threads, next_phase);
+
+	auto work = [&](int thread_id) {
+		vector<vector<int>>& own = buckets[thread_id];
+		while (phase != PHASE_DONE) {
+			if (phase == PHASE_LIGHT) {
+				size_t begin = (frontier.size() * thread_id) / num_threads;
+				size_t end = (frontier.size() * (thread_id + 1)) / num_threads;
+				for (size_t slot = begin; slot < end; slot++) {
+					int node = frontier[slot];
+					int cost = atomic_ref<int>(g[node]).load(memory_order_relaxed);
+					// Nodes filed in a bucket and later lowered into an earlier one are already done
+					if ((size_t) (cost / delta) != current) {
+						continue;
+					}
+					if (has_heavy) {
+						settled[thread_id].push_back(node);
+					}
+
+					for (neighbor_t next : grid.neighbors(node)) {
+						int new_cost = cost + next.cost;
+						if ((next.cost <= delta) && lower_cost(g, next.index, new_cost)) {
+							size_t index = (size_t) (new_cost / delta);
+							if (index >= own.size()) {
+								own.resize(index + 1);
+							}
+							own[index].push_back(next.index);
+						}
+					}
+				}
+			}
+			else {
+				// Every node settled in the bucket has its final cost, so its heavy moves are made once
+				for (int node : settled[thread_id]) {
+					int cost = atomic_ref<int>(g[node]).load(memory_order_relaxed);
+					for (neighbor_t next : grid.neighbors(node)) {
+						int new_cost = cost + next.cost;
+						if ((next.cost > delta) && lower_cost(g, next.index, new_cost)) {
+							size_t index = (size_t) (new_cost / delta);
+							if (index >= own.size()) {
+								own.resize(index + 1);
+							}
+							own[index].push_back(next.index);
+						}
+					}
+				}
+				settled[thread_id].clear();
+			}
+			sync.arrive_and_wait();
+		}
+	};
+
+	vector<thread> threads;
+	for (int thread_id = 1; thread_id < num_threads; thread_id++) {
+		threads.push_back(thread(work, thread_id));
+	}
+	work(0);
+	for (thread& worker : threads) {
+		worker.join();
+	}
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* DeltaStepping::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the cost between the source and a cell (max_cost if it can't be reached)
+int DeltaStepping::get_cost_to_go(int x, int y) {
+	return grid.g[grid.index(x, y)];
+}
+
+// Returns the flat array of every cell's cost, indexed by get_node_map()->index(x, y)
+const int* DeltaStepping::get_distances() {
+	return grid.g;
+}
+
+// Moves the source and recomputes every cost
+void DeltaStepping::set_source(int source_x, int source_y) {
+	this->source_x = source_x;
+	this->source_y = source_y;
+	compute();
+}
+
+// Updates the occupancy map and recomputes every cost
+void DeltaStepping::update_occupancy_map(bool** occupancy_map) {
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			grid.set_occupancy(grid.index(row, col), occupancy_map[row][col]);
+		}
+	}
+	compute();
+}
+
+// Returns the number of phases (barriers) the last computation took
+int DeltaStepping::get_phases() {
+	return this->phases;
+}
@@ -1,9 +1,9 @@
 // Imports
-#include "header.hh"
+#include "grid_search.hpp"
 
 
 // Constructors
-Dijkstra::Dijkstra(bool** occ_map, int rows, int cols) {
+Dijkstra::Dijkstra(bool** occ_map, int rows, int cols) : grid(rows, cols, occ_map), pq(grid.get_num_nodes()) {
 	this->rows = rows;
 	this->cols = cols;
 
@@ -11,66 +11,102 @@ Dijkstra::Dijkstra(bool** occ_map, int rows, int cols) {
 	this->start_y = 0;
 	this->goal_x = rows - 1;
 	this->goal_y = cols - 1;
-
-	this->node_map = (node_t**) NodeMap::initialize_node_map(rows, cols, occ_map, start_x, start_y);
-	this->pq = NodePriorityQueue();
-	this->explored = unordered_set<node_t *>();
+	this->queue_type = QUEUE_BINARY_HEAP;
+	start_search();
 }
 
-Dijkstra::Dijkstra(bool** occ_map, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) {
+Dijkstra::Dijkstra(bool** occ_map, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_map), pq(grid.get_num_nodes()) {
 	this->rows = rows;
 	this->cols = cols;
-	this->pq = NodePriorityQueue();
 
 	this->start_x = start_x;
 	this->start_y = start_y;
 	this->goal_x = goal_x;
 	this->goal_y = goal_y;
+	this->queue_type = QUEUE_BINARY_HEAP;
+	start_search();
+}
+
+
+// Dijkstra is the engine with no heuristic
+typedef zero_heuristic<octile_costs> no_heuristic;
+
+/*
+ * Starts a new resumable search from start to goal. Nodes left over from the
+ * last search go stale instead of being reset. Call step to make progress.
+ */
+void Dijkstra::start_search() {
+	pq.clear();
+	bq.clear();
+	int start = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	if (queue_type == QUEUE_BUCKET) {
+		begin_grid_search(grid, bq, search, no_heuristic(goal_x, goal_y), start, goal);
+	}
+	else {
+		begin_grid_search(grid, pq, search, no_heuristic(goal_x, goal_y), start, goal);
+	}
+}
+
+// Starts a new resumable search between a new start and goal
+void Dijkstra::start_search(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	start_search();
+}
 
-	this->node_map = (node_t**)NodeMap::initialize_node_map(rows, cols, occ_map, start_x, start_y);
-	this->pq = NodePriorityQueue();
+/*
+ * Expands at most max_expansions nodes of the "cloud" and returns where the
+ * search stands. Once it has finished, further calls return the same status.
+ * Popped nodes already have their final cost, so they are never relaxed again
+ * and don't need to be tracked separately.
+ */
+search_status_t Dijkstra::step(int max_expansions) {
+	if (queue_type == QUEUE_BUCKET) {
+		return step_grid_search<no_heuristic, 8, octile_costs>(grid, bq, search, no_heuristic(goal_x, goal_y),
+			max_expansions);
+	}
+	return step_grid_search<no_heuristic, 8, octile_costs>(grid, pq, search, no_heuristic(goal_x, goal_y),
+		max_expansions);
+}
+
+// Returns where the current search stands
+search_status_t Dijkstra::get_status() {
+	return this->search.status;
 }
 
+/*
+ * Returns the best path known so far: the full path once the goal has been
+ * found, otherwise the path to the expanded node closest to the goal.
+ */
+vector<tuple<int, int>> Dijkstra::get_partial_path() {
+	return partial_grid_path(grid, search);
+}
 
 // Computes the min distance matrix
 bool Dijkstra::compute() {
-	// Initializing
-	CNode::set_cost(&node_map[start_x][start_y], 0);
-	pq.push(&node_map[start_x][start_y]);
-
-	// Recursively expanding "cloud"
-	do {
-		node_t* of_interest = pq.pop();
-		if ((of_interest->x == goal_x) && (of_interest->y == goal_y)) {
-			// Reached the goal
-			return true;
-		}
-
-		this->explored.insert(of_interest);
-		vector<node_t*> neighbors = NodeMap::get_neighbors(node_map, of_interest->x, of_interest->y, rows, cols);
-		for (int index = 0; index < neighbors.size(); index++) {
-			node_t* neighbor = neighbors[index];
-			// Not part of explored cloud
-			if (explored.find(neighbor) == explored.end()) {
-				if (pq.find(neighbor) == -1) {
-					CNode::set_cost(neighbor, CNode::get_cost(of_interest) + COST);
-					pq.push(neighbor);
-				}
-				else {
-					if (CNode::get_cost(of_interest) + COST < CNode::get_cost(neighbor)) {
-						pq.update_node_cost(neighbor, CNode::get_cost(of_interest) + COST);
-					}
-				}
-			}
-		}
-	} while (!pq.isEmpty());
-
-	return false;
+	start_search();
+	return (step(max_cost) == SEARCH_FOUND);
+}
+
+/*
+ * Selects the queue for step and generate_path and restarts the current
+ * search with it. Costs are small integers, so the bucket queue's O(1) push
+ * and pop give the same paths as the binary heap.
+ */
+void Dijkstra::set_queue_type(queue_type_t queue_type) {
+	if ((queue_type == QUEUE_BUCKET) && (this->queue_type != QUEUE_BUCKET)) {
+		bq = BucketQueue(grid.get_num_nodes());
+	}
+	this->queue_type = queue_type;
+	start_search();
 }
 
-// Returns the node map assosiated with this instance
-node_t** Dijkstra::get_node_map() {
-	return this->node_map;
+// Returns the node grid assosiated with this instance
+NodeGrid* Dijkstra::get_node_map() {
+	return &this->grid;
 }
 
 // Finds whether a path exists and if so, traces it
@@ -78,7 +114,16 @@ vector<tuple<int, int>> Dijkstra::generate_path() {
 	bool path_exists = compute();
 	vector<tuple<int, int>> path;
 	if (path_exists) {
-		path = NodeMap::trace_path(this->node_map, goal_x, goal_y, rows, cols);
+		path = grid.trace_path(grid.index(goal_x, goal_y));
 	}
 	return path;
-}
\ No newline at end of file
+}
+
+// Plans between a new start and goal, reusing this instance's grid and pq
+vector<tuple<int, int>> Dijkstra::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
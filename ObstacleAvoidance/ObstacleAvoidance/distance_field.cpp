@@ -0,0 +1,202 @@
+// Includes
+#include "header.hh"
+
+
+// Defining DistanceField Class
+// Constructor, which builds the whole field for the given goal
+DistanceField::DistanceField(bool** occ_matrix, int rows, int cols, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
+	this->rows = rows;
+	this->cols = cols;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	this->expansions = 0;
+
+	// The field keeps its values between queries, so it doesn't use lazy resets
+	grid.reset();
+	compute();
+}
+
+// Returns g of a node, which is stored in the grid's cost (max_rhs if infinite)
+float DistanceField::get_g(int node) {
+	int cost = grid.g[node];
+	return (cost == max_cost) ? max_rhs : (float) cost;
+}
+
+// Sets g of a node
+void DistanceField::set_g(int node, float g) {
+	grid.g[node] = (g >= max_rhs) ? max_cost : (int) g;
+}
+
+/*
+ * Backwards Dijkstra from the goal over every reachable cell. Moves cost the
+ * same in both directions, so the cost from the goal to a cell is the cell's
+ * cost-to-go, and the node it was reached from is where it should step next.
+ * Unlike Dijkstra::compute this doesn't stop early, since any cell may be a
+ * start later on.
+ */
+void DistanceField::compute() {
+	int goal = grid.index(goal_x, goal_y);
+	grid.g[goal] = 0;
+	grid.rhs[goal] = 0;
+	pq.push(goal, { 0, 0 });
+
+	while (!pq.isEmpty()) {
+		int of_interest = pq.pop();
+		expansions++;
+
+		for (neighbor_t next : grid.neighbors(of_interest)) {
+			int neighbor = next.index, new_cost = grid.g[of_interest] + next.cost;
+			if (new_cost < grid.g[neighbor]) {
+				grid.g[neighbor] = new_cost;
+				grid.rhs[neighbor] = (float) new_cost;
+				grid.parents[neighbor] = of_interest;
+				if (!pq.contains(neighbor)) {
+					pq.push(neighbor, { (float) new_cost, (float) new_cost });
+				}
+				else {
+					pq.decrease_key(neighbor, { (float) new_cost, (float) new_cost });
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Recomputes rhs of a node from its cheapest free neighbor, which also becomes
+ * its descent direction, and (re)queues it only if it's inconsistent.
+ */
+void DistanceField::update_vertex(int node) {
+	if (node != grid.index(goal_x, goal_y)) {
+		float min_rhs = max_rhs;
+		int best = -1;
+		if (!grid.get_occupancy(node)) {
+			for (neighbor_t neighbor : grid.neighbors(node)) {
+				float neighbor_g = get_g(neighbor.index);
+				if ((neighbor_g < max_rhs) && (neighbor_g + neighbor.cost < min_rhs)) {
+					min_rhs = neighbor_g + neighbor.cost;
+					best = neighbor.index;
+				}
+			}
+		}
+		grid.rhs[node] = min_rhs;
+		grid.parents[node] = best;
+	}
+
+	if (get_g(node) != grid.rhs[node]) {
+		float min_g = min(get_g(node), grid.rhs[node]);
+		pq.push(node, { min_g, min_g });
+	}
+	else {
+		pq.remove(node);
+	}
+}
+
+/*
+ * Expands inconsistent nodes until none are left. Lowered nodes settle in
+ * one expansion; raised nodes are set to infinity first so everything that
+ * routed through them gets redone.
+ */
+void DistanceField::repair() {
+	while (!pq.isEmpty()) {
+		int of_interest = pq.top();
+		expansions++;
+
+		if (get_g(of_interest) > grid.rhs[of_interest]) {
+			// Overconsistent, so the node's cost can be lowered
+			set_g(of_interest, grid.rhs[of_interest]);
+			pq.remove(of_interest);
+		}
+		else {
+			// Underconsistent, so the node and everything routed through it must be redone
+			set_g(of_interest, max_rhs);
+			update_vertex(of_interest);
+		}
+		for (neighbor_t neighbor : grid.neighbors(of_interest)) {
+			update_vertex(neighbor.index);
+		}
+	}
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* DistanceField::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of nodes expanded since this instance was created
+int DistanceField::get_expansions() {
+	return this->expansions;
+}
+
+// Returns the cost from a cell to the goal (max_cost if the goal can't be reached)
+int DistanceField::get_cost_to_go(int x, int y) {
+	repair();
+	return grid.g[grid.index(x, y)];
+}
+
+// Returns the step to take from a cell towards the goal ((0, 0) at the goal or if it can't be reached)
+tuple<int, int> DistanceField::get_direction(int x, int y) {
+	repair();
+	int node = grid.index(x, y), next = grid.parents[node];
+	if ((grid.g[node] == max_cost) || (next == -1)) {
+		return make_tuple(0, 0);
+	}
+	return make_tuple(grid.row_of(next) - x, grid.col_of(next) - y);
+}
+
+/*
+ * Returns the path from a start to the goal by following the descent
+ * directions, which is O(path length). The path runs start --> finish,
+ * excluding the start like NodeGrid::trace_path, and is empty if the goal
+ * can't be reached.
+ */
+vector<tuple<int, int>> DistanceField::generate_path(int start_x, int start_y) {
+	repair();
+	vector<tuple<int, int>> path;
+	int current = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	if (grid.g[current] == max_cost) {
+		return path;
+	}
+
+	while ((current != goal) && (path.size() < (size_t) rows * cols)) {
+		current = grid.parents[current];
+		path.push_back(make_tuple(grid.row_of(current), grid.col_of(current)));
+	}
+	return path;
+}
+
+/*
+ * Changes the occupancy of a single cell and queues the cell and its neighbors
+ * for repair. Repairs are deferred to the next query, so a batch of changes is
+ * repaired together.
+ */
+void DistanceField::update_occupancy(int row, int col, bool occupied) {
+	int changed = grid.index(row, col);
+	if (grid.get_occupancy(changed) == occupied) {
+		return;
+	}
+	grid.set_occupancy(changed, occupied);
+
+	update_vertex(changed);
+	for (int d_row = -1; d_row <= 1; d_row++) {
+		for (int d_col = -1; d_col <= 1; d_col++) {
+			if (((d_row != 0) || (d_col != 0)) &&
+				!grid.outOfBounds(row + d_row, col + d_col)) {
+				update_vertex(grid.index(row + d_row, col + d_col));
+			}
+		}
+	}
+}
+
+/*
+ * Updates the occupancy map. Comparing against the new map is a full scan, but
+ * only cells whose occupancy changed are repaired. Callers that already know
+ * which cells changed should use update_occupancy directly.
+ */
+void DistanceField::update_occupancy_map(bool** occupancy_map) {
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			update_occupancy(row, col, occupancy_map[row][col]);
+		}
+	}
+}
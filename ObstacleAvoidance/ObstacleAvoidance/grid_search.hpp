@@ -0,0 +1,297 @@
+// Prevents multiple definitions
+#pragma once
+
+// Includes
+#include "header.hh"
+
+
+/*
+ * Header-only best-first search engine over a NodeGrid. The heuristic, the
+ * queue, the connectivity and the cost table are all template parameters, so
+ * every combination compiles to its own loop with the heuristic and neighbor
+ * costs inlined. Dijkstra and AStar run their searches through it, and
+ * GridSearch packages it up as a standalone planner.
+ *
+ * A heuristic policy is constructed from the goal's row and column and
+ * returns its estimate of the cost from a cell to the goal. It has to be
+ * consistent for the search to stay optimal, and integer valued for
+ * BucketQueue. A policy that is always 0 sets informative to false, so the
+ * search skips storing it and ranks partial paths by the squared
+ * straight-line distance instead.
+ */
+
+
+// No estimate at all, which makes the search Dijkstra's algorithm
+template <typename cost_table = octile_costs>
+struct zero_heuristic {
+	static constexpr bool informative = false;
+
+	zero_heuristic(int, int) {}
+
+	inline float operator()(int, int) const {
+		return 0;
+	}
+};
+
+/*
+ * Straight-line distance scaled by the cheapest cost per unit of distance:
+ * a straight move covers 1 for costs[0] and a diagonal covers sqrt(2) for
+ * costs[4]. Consistent for any cost table, but not integer valued.
+ */
+template <typename cost_table = octile_costs>
+struct euclidean_heuristic {
+	static constexpr bool informative = true;
+	int goal_row, goal_col;
+	float scale;
+
+	euclidean_heuristic(int goal_row, int goal_col) {
+		this->goal_row = goal_row;
+		this->goal_col = goal_col;
+		this->scale = min((float) cost_table::costs[0], (float) (cost_table::costs[4] / sqrt(2.0)));
+	}
+
+	inline float operator()(int row, int col) const {
+		int d_row = goal_row - row, d_col = goal_col - col;
+		return scale * sqrtf((float) ((d_row * d_row) + (d_col * d_col)));
+	}
+};
+
+/*
+ * Octile distance: the cheapest obstacle-free 8-connected path, which takes
+ * min(|dx|, |dy|) diagonal moves and the rest straight. Exact on an empty
+ * grid, consistent while a diagonal costs no more than two straight moves,
+ * and integer valued.
+ */
+template <typename cost_table = octile_costs>
+struct octile_heuristic {
+	static constexpr bool informative = true;
+	static constexpr int straight = cost_table::costs[0];
+	static constexpr int diagonal = min(cost_table::costs[4], 2 * cost_table::costs[0]);
+	int goal_row, goal_col;
+
+	octile_heuristic(int goal_row, int goal_col) {
+		this->goal_row = goal_row;
+		this->goal_col = goal_col;
+	}
+
+	inline float operator()(int row, int col) const {
+		int d_row = abs(goal_row - row), d_col = abs(goal_col - col);
+		int diagonals = min(d_row, d_col), straights = max(d_row, d_col) - diagonals;
+		return (float) ((diagonal * diagonals) + (straight * straights));
+	}
+};
+
+/*
+ * ALT: the larger of octile distance and every landmark's bound
+ * |d(L, goal) - d(L, cell)|, read from a Landmarks' tables. Each is
+ * consistent for octile costs, so their max is too, and integer valued.
+ * Without landmarks it's plain octile distance. The goal's costs are looked
+ * up once, so the estimate for a cell reads one row of the tables.
+ */
+struct landmark_heuristic {
+	static constexpr bool informative = true;
+	octile_heuristic<octile_costs> octile;
+	Landmarks* landmarks;
+	int num_landmarks;
+	int goal_costs[MAX_LANDMARKS];
+
+	landmark_heuristic(int goal_row, int goal_col) : landmark_heuristic(goal_row, goal_col, NULL) {}
+
+	landmark_heuristic(int goal_row, int goal_col, Landmarks* landmarks) : octile(goal_row, goal_col) {
+		this->landmarks = landmarks;
+		this->num_landmarks = (landmarks == NULL) ? 0 : landmarks->get_num_landmarks();
+		if (num_landmarks > 0) {
+			const int* costs = landmarks->get_costs(landmarks->index(goal_row, goal_col));
+			copy(costs, costs + num_landmarks, goal_costs);
+		}
+	}
+
+	inline float operator()(int row, int col) const {
+		int h = (int) octile(row, col);
+		if (num_landmarks > 0) {
+			const int* costs = landmarks->get_costs(landmarks->index(row, col));
+			for (int landmark = 0; landmark < num_landmarks; landmark++) {
+				// A landmark that can't reach both ends says nothing about the cost between them
+				if ((costs[landmark] != max_cost) && (goal_costs[landmark] != max_cost)) {
+					h = max(h, abs(goal_costs[landmark] - costs[landmark]));
+				}
+			}
+		}
+		return (float) h;
+	}
+};
+
+
+// Seeds a search from start to goal in a queue that the caller has cleared
+template <typename heuristic_t, typename queue_t>
+inline void begin_grid_search(NodeGrid& grid, queue_t& queue, search_state_t& state, const heuristic_t& heuristic,
+	int start, int goal) {
+	grid.begin_search();
+	grid.visit(start);
+	grid.g[start] = 0;
+	grid.heuristic[start] = heuristic(grid.row_of(start), grid.col_of(start));
+	queue.push(start, { grid.heuristic[start], 0 });
+
+	state.goal = goal;
+	state.best_node = start;
+	state.best_rank = max_heuristic;
+	state.expansions = 0;
+	state.status = SEARCH_IN_PROGRESS;
+}
+
+/*
+ * Expands at most max_expansions nodes in order of g + h and returns where
+ * the search stands. Improved nodes are pushed again, which both queues treat
+ * as a key update.
+ */
+template <typename heuristic_t, int connectivity, typename cost_table, typename queue_t>
+search_status_t step_grid_search(NodeGrid& grid, queue_t& queue, search_state_t& state, const heuristic_t& heuristic,
+	int max_expansions) {
+	if (state.status != SEARCH_IN_PROGRESS) {
+		return state.status;
+	}
+
+	int goal_row = grid.row_of(state.goal), goal_col = grid.col_of(state.goal);
+	for (int budget = max_expansions; budget > 0; budget--) {
+		if (queue.isEmpty()) {
+			state.status = SEARCH_UNREACHABLE;
+			return state.status;
+		}
+
+		int of_interest = queue.pop();
+		state.expansions++;
+		if (of_interest == state.goal) {
+			state.status = SEARCH_FOUND;
+			return state.status;
+		}
+
+		// Ranking the node for partial paths
+		float rank;
+		if constexpr (heuristic_t::informative) {
+			rank = grid.heuristic[of_interest];
+		}
+		else {
+			int d_row = goal_row - grid.row_of(of_interest), d_col = goal_col - grid.col_of(of_interest);
+			rank = (float) ((d_row * d_row) + (d_col * d_col));
+		}
+		if (rank < state.best_rank) {
+			state.best_node = of_interest;
+			state.best_rank = rank;
+		}
+
+		// Expanding neighbors
+		for (neighbor_t next : grid.neighbors<connectivity, cost_table>(of_interest)) {
+			int neighbor = next.index, new_cost = grid.g[of_interest] + next.cost;
+			grid.visit(neighbor);
+			if (new_cost < grid.g[neighbor]) {
+				float h = 0;
+				if constexpr (heuristic_t::informative) {
+					if (grid.g[neighbor] == max_cost) {
+						grid.heuristic[neighbor] = heuristic(grid.row_of(neighbor), grid.col_of(neighbor));
+					}
+					h = grid.heuristic[neighbor];
+				}
+				grid.g[neighbor] = new_cost;
+				grid.parents[neighbor] = of_interest;
+				queue.push(neighbor, { h + new_cost, (float) new_cost });
+			}
+		}
+	}
+
+	if (queue.isEmpty()) {
+		state.status = SEARCH_UNREACHABLE;
+	}
+	return state.status;
+}
+
+// Returns the path to the goal if it was found, otherwise to the best node so far
+inline vector<tuple<int, int>> partial_grid_path(NodeGrid& grid, const search_state_t& state) {
+	return grid.trace_path((state.status == SEARCH_FOUND) ? state.goal : state.best_node);
+}
+
+
+/*
+ * Standalone planner built on the engine, with the same API as Dijkstra and
+ * AStar minus their run-time options. For example,
+ * GridSearch<octile_heuristic<>, BucketQueue> is an integer A* and
+ * GridSearch<zero_heuristic<>, NodePriorityQueue, 4> is a 4-connected Dijkstra.
+ */
+template <typename heuristic_t, typename queue_t, int connectivity = 8, typename cost_table = octile_costs>
+class GridSearch {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	search_state_t search;
+	queue_t queue;
+
+public:
+	// Constructors
+	GridSearch(bool** occ_matrix, int rows, int cols) : GridSearch(occ_matrix, rows, cols, 0, 0, rows - 1, cols - 1) {}
+
+	GridSearch(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+		grid(rows, cols, occ_matrix), queue(grid.get_num_nodes()) {
+		this->rows = rows;
+		this->cols = cols;
+		start_search(start_x, start_y, goal_x, goal_y);
+	}
+
+	// Returns the node grid assosiated with this instance
+	NodeGrid* get_node_map() {
+		return &this->grid;
+	}
+
+	// Returns the number of nodes popped off the queue during the last search
+	int get_expansions() {
+		return this->search.expansions;
+	}
+
+	// Starts a new resumable search from start to goal
+	void start_search() {
+		queue.clear();
+		begin_grid_search(grid, queue, search, heuristic_t(goal_x, goal_y), grid.index(start_x, start_y),
+			grid.index(goal_x, goal_y));
+	}
+
+	// Starts a new resumable search between a new start and goal
+	void start_search(int start_x, int start_y, int goal_x, int goal_y) {
+		this->start_x = start_x;
+		this->start_y = start_y;
+		this->goal_x = goal_x;
+		this->goal_y = goal_y;
+		start_search();
+	}
+
+	// Expands at most max_expansions nodes and returns where the search stands
+	search_status_t step(int max_expansions) {
+		return step_grid_search<heuristic_t, connectivity, cost_table>(grid, queue, search,
+			heuristic_t(goal_x, goal_y), max_expansions);
+	}
+
+	// Returns where the current search stands
+	search_status_t get_status() {
+		return this->search.status;
+	}
+
+	// Returns the full path once found, otherwise the path to the node closest to the goal
+	vector<tuple<int, int>> get_partial_path() {
+		return partial_grid_path(grid, search);
+	}
+
+	// Searches from scratch and returns the path, which is empty if there's none
+	vector<tuple<int, int>> generate_path() {
+		start_search();
+		if (step(max_cost) != SEARCH_FOUND) {
+			return vector<tuple<int, int>>();
+		}
+		return grid.trace_path(search.goal);
+	}
+
+	// Plans between a new start and goal, reusing this instance's grid and queue
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+		this->start_x = start_x;
+		this->start_y = start_y;
+		this->goal_x = goal_x;
+		this->goal_y = goal_y;
+		return generate_path();
+	}
+};
@@ -0,0 +1,360 @@
+// Includes
+#include "grid_search.hpp"
+#include <queue>
+
+// Cells are handed out to workers in square blocks of 2^HDA_BLOCK_SHIFT cells on a side
+#define HDA_BLOCK_SHIFT (4)
+
+// Messages each ring between two workers holds (always a power of 2)
+#define HDA_RING_SIZE (4096)
+
+// Expansions a worker makes between checks of its inbox
+#define HDA_EXPANSIONS_PER_POLL (64)
+
+
+// Defining ParallelAStar Class
+typedef octile_heuristic<octile_costs> hda_heuristic;
+
+// A node reached by one worker and sent to its owner, with the cost and parent it was reached with
+typedef struct hda_message {
+	int node, g, parent;
+} hda_message_t;
+
+// Entry of a worker's open list. Entries aren't removed when a node improves, so stale ones are skipped on pop.
+typedef struct hda_entry {
+	int f, g, node;
+
+	// Orders by smallest f first and then by largest g, which is closer to the goal
+	bool operator <(const hda_entry& other) const {
+		return (f > other.f) || ((f == other.f) && (g < other.g));
+	}
+} hda_entry_t;
+
+/*
+ * Lock-free single-producer single-consumer ring of messages. The producer
+ * only writes tail and the consumer only writes head, and each sits on its
+ * own cache line so the two threads don't fight over one.
+ */
+class MessageRing {
+	alignas(64) atomic<unsigned int> head;
+	alignas(64) atomic<unsigned int> tail;
+	alignas(64) hda_message_t slots[HDA_RING_SIZE];
+
+public:
+	MessageRing() : head(0), tail(0) {}
+
+	// Empties the ring, which only the thread that owns both ends may do
+	void clear() {
+		head.store(0, memory_order_relaxed);
+		tail.store(0, memory_order_relaxed);
+	}
+
+	// Adds a message, returning false if the ring is full
+	bool push(const hda_message_t& message) {
+		unsigned int at = tail.load(memory_order_relaxed);
+		if (at - head.load(memory_order_acquire) == HDA_RING_SIZE) {
+			return false;
+		}
+		slots[at & (HDA_RING_SIZE - 1)] = message;
+		tail.store(at + 1, memory_order_release);
+		return true;
+	}
+
+	// Takes the oldest message, returning false if the ring is empty
+	bool pop(hda_message_t* message) {
+		unsigned int at = head.load(memory_order_relaxed);
+		if (at == tail.load(memory_order_acquire)) {
+			return false;
+		}
+		*message = slots[at & (HDA_RING_SIZE - 1)];
+		head.store(at + 1, memory_order_release);
+		return true;
+	}
+};
+
+/*
+ * Everything the workers of one search share. rings[receiver * num_threads
+ * + sender] carries messages from sender to receiver. tokens counts the
+ * workers that are busy plus the messages that haven't been handled yet, so
+ * when it hits 0 nothing is left anywhere and it can't go back up. incumbent
+ * is the best cost the goal has been reached with.
+ */
+typedef struct hda_shared {
+	NodeGrid* grid;
+	int num_threads, goal;
+	hda_heuristic heuristic;
+	MessageRing* rings;
+	atomic<long long> tokens;
+	atomic<int> incumbent;
+} hda_shared_t;
+
+// Returns which worker owns a node (a mix of its block's coordinates, so blocks spread out evenly)
+static inline int owner_of(NodeGrid& grid, int node, int num_threads) {
+	unsigned int block_row = (unsigned int) grid.row_of(node) >> HDA_BLOCK_SHIFT;
+	unsigned int block_col = (unsigned int) grid.col_of(node) >> HDA_BLOCK_SHIFT;
+	unsigned int hash = (block_row * 0x9E3779B1u) ^ (block_col * 0x85EBCA77u);
+	hash ^= hash >> 15;
+	return (int) (hash % (unsigned int) num_threads);
+}
+
+/*
+ * Offers a node to its owner, which is the calling worker: if the cost is an
+ * improvement, the node is (re)opened unless it can't beat the incumbent.
+ * Reaching the goal lowers the incumbent.
+ */
+static inline void relax(hda_shared_t& shared, priority_queue<hda_entry_t>& open, int node, int g, int parent) {
+	NodeGrid& grid = *shared.grid;
+	grid.visit(node);
+	if (g >= grid.g[node]) {
+		return;
+	}
+	if (grid.g[node] == max_cost) {
+		grid.heuristic[node] = shared.heuristic(grid.row_of(node), grid.col_of(node));
+	}
+	grid.g[node] = g;
+	grid.parents[node] = parent;
+
+	if (node == shared.goal) {
+		int current = shared.incumbent.load(memory_order_relaxed);
+		while ((g < current) && !shared.incumbent.compare_exchange_weak(current, g, memory_order_relaxed)) {}
+		return;
+	}
+	int f = g + (int) grid.heuristic[node];
+	if (f < shared.incumbent.load(memory_order_relaxed)) {
+		open.push({ f, g, node });
+	}
+}
+
+/*
+ * Body of one worker. It alternates between handling its inbox and making a
+ * few expansions, and sends neighbors it doesn't own in bulk after each
+ * round. A worker gives up its token once it has nothing to do, takes one
+ * back over with the first message that reaches it, and returns once the
+ * tokens run out. Returns how many messages it sent, and adds its
+ * expansions to the given counter.
+ */
+static long long run_worker(hda_shared_t* shared_ptr, int worker, int* expansions) {
+	hda_shared_t& shared = *shared_ptr;
+	NodeGrid& grid = *shared.grid;
+	int num_threads = shared.num_threads;
+	priority_queue<hda_entry_t> open;
+	vector<vector<hda_message_t>> outbox(num_threads);
+	bool busy = true;
+	long long sent = 0;
+	*expansions = 0;
+
+	while (true) {
+		// Handling the inbox
+		long long received = 0;
+		hda_message_t message;
+		for (int sender = 0; sender < num_threads; sender++) {
+			MessageRing& ring = shared.rings[(worker * num_threads) + sender];
+			while (ring.pop(&message)) {
+				relax(shared, open, message.node, message.g, message.parent);
+				received++;
+			}
+		}
+		if (received > 0) {
+			if (!busy) {
+				busy = true;
+				received--;
+			}
+			shared.tokens.fetch_sub(received);
+		}
+
+		// Expanding the best nodes that can still beat the incumbent
+		for (int budget = HDA_EXPANSIONS_PER_POLL; (budget > 0) && !open.empty(); ) {
+			hda_entry_t entry = open.top();
+			if (entry.f >= shared.incumbent.load(memory_order_relaxed)) {
+				open = priority_queue<hda_entry_t>();
+				break;
+			}
+			open.pop();
+			if (entry.g != grid.g[entry.node]) {
+				continue;
+			}
+			budget--;
+			(*expansions)++;
+
+			for (neighbor_t next : grid.neighbors(entry.node)) {
+				int new_cost = entry.g + next.cost, owner = owner_of(grid, next.index, num_threads);
+				if (owner == worker) {
+					relax(shared, open, next.index, new_cost, entry.node);
+				}
+				else {
+					outbox[owner].push_back({ next.index, new_cost, entry.node });
+				}
+			}
+		}
+
+		// Sending, where every message gets its token before it can be seen
+		bool unsent = false;
+		for (int receiver = 0; receiver < num_threads; receiver++) {
+			vector<hda_message_t>& outgoing = outbox[receiver];
+			if (outgoing.empty()) {
+				continue;
+			}
+			MessageRing& ring = shared.rings[(receiver * num_threads) + worker];
+			shared.tokens.fetch_add((long long) outgoing.size());
+			size_t pushed = 0;
+			while ((pushed < outgoing.size()) && ring.push(outgoing[pushed])) {
+				pushed++;
+			}
+			shared.tokens.fetch_sub((long long) (outgoing.size() - pushed));
+			sent += (long long) pushed;
+			outgoing.erase(outgoing.begin(), outgoing.begin() + pushed);
+			unsent = unsent || !outgoing.empty();
+		}
+
+		// Going idle once there's nothing left to expand or send
+		if (open.empty() && !unsent) {
+			if (busy) {
+				busy = false;
+				shared.tokens.fetch_sub(1);
+			}
+			if (shared.tokens.load() == 0) {
+				return sent;
+			}
+			this_thread::yield();
+		}
+	}
+}
+
+
+// Constructors
+ParallelAStar::ParallelAStar(bool** occ_matrix, int rows, int cols) :
+	ParallelAStar(occ_matrix, rows, cols, 0, 0, rows - 1, cols - 1) {}
+
+ParallelAStar::ParallelAStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	this->rows = rows;
+	this->cols = cols;
+	this->num_threads = 0;
+	this->expansions = 0;
+	this->messages = 0;
+	set_num_threads((int) thread::hardware_concurrency());
+}
+
+// Destructor, defined here where MessageRing is complete
+ParallelAStar::~ParallelAStar() {}
+
+/*
+ * Runs the workers to completion and returns whether the goal was reached.
+ * The start is seeded into its owner's inbox as a message from itself, so
+ * every worker starts out the same way.
+ */
+bool ParallelAStar::compute() {
+	int start = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	grid.begin_search();
+	expansions = 0;
+	messages = 0;
+	if (start == goal) {
+		grid.visit(start);
+		grid.g[start] = 0;
+		return true;
+	}
+
+	// The rings are kept between searches, and only their indices need resetting
+	for (int ring = 0; ring < num_threads * num_threads; ring++) {
+		rings[ring].clear();
+	}
+	hda_shared_t shared = { &grid, num_threads, goal, hda_heuristic(goal_x, goal_y), rings.get(), num_threads + 1LL,
+		max_cost };
+	int first = owner_of(grid, start, num_threads);
+	shared.rings[(first * num_threads) + first].push({ start, 0, -1 });
+
+	vector<thread> workers;
+	vector<int> worker_expansions(num_threads, 0);
+	vector<long long> worker_messages(num_threads, 0);
+	for (int worker = 1; worker < num_threads; worker++) {
+		workers.push_back(thread([&, worker] {
+			worker_messages[worker] = run_worker(&shared, worker, &worker_expansions[worker]);
+		}));
+	}
+	worker_messages[0] = run_worker(&shared, 0, &worker_expansions[0]);
+	for (thread& worker : workers) {
+		worker.join();
+	}
+
+	for (int worker = 0; worker < num_threads; worker++) {
+		expansions += worker_expansions[worker];
+		messages += worker_messages[worker];
+	}
+	return (shared.incumbent.load() != max_cost);
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* ParallelAStar::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of nodes expanded by all workers during the last search (reopened nodes count again)
+int ParallelAStar::get_expansions() {
+	return this->expansions;
+}
+
+// Returns the number of nodes sent from one worker to another during the last search
+long long ParallelAStar::get_messages() {
+	return this->messages;
+}
+
+/*
+ * Sets how many worker threads the next searches use (at least one). Every
+ * pair of workers has a ring, so the rings (num_threads^2 of them) are only
+ * reallocated here when the count changes, not for every search.
+ */
+void ParallelAStar::set_num_threads(int num_threads) {
+	num_threads = max(1, num_threads);
+	if (num_threads != this->num_threads) {
+		rings.reset(new MessageRing[num_threads * num_threads]);
+		this->num_threads = num_threads;
+	}
+}
+
+int ParallelAStar::get_num_threads() {
+	return this->num_threads;
+}
+
+// Searches with every worker and returns the path, which is empty if there's none
+vector<tuple<int, int>> ParallelAStar::generate_path() {
+	this->path.clear();
+	if (compute()) {
+		this->path = grid.trace_path(grid.index(goal_x, goal_y));
+	}
+	return this->path;
+}
+
+// Plans between a new start and goal, reusing this instance's grid
+vector<tuple<int, int>> ParallelAStar::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
+
+/*
+ * Given a new occupancy map, this updates the grid. Returns true if the
+ * current path is blocked (or there is none) and needs to be recomputed.
+ */
+bool ParallelAStar::update_occupancy_map(bool** occupancy_map) {
+	bool recomputePath = (this->path.size() == 0);
+	for (tuple<int, int> step : path) {
+		if (occupancy_map[get<0>(step)][get<1>(step)] == true) {
+			recomputePath = true;
+			break;
+		}
+	}
+
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			grid.set_occupancy(grid.index(row, col), occupancy_map[row][col]);
+		}
+	}
+
+	return recomputePath;
+}
@@ -12,12 +12,16 @@
 #include <chrono>
 #include <thread>
 #include <mutex> 
+#include <atomic>
+#include <condition_variable>
 #include <malloc.h>
 #include <vector>
 #include <tuple>
 #include <limits>
 #include <chrono>
 #include <unordered_set>
+#include <memory>
+#include <stdint.h>
 
 // Primary Libraries
 #include <librealsense2/rs.hpp>
@@ -34,104 +38,202 @@ using namespace std::chrono;
 #define HEIGHT (480)
 
 #define COST (2)
+#define STRAIGHT_COST (10)
+#define DIAGONAL_COST (14)
+
+// Most landmarks a Landmarks instance keeps tables for
+#define MAX_LANDMARKS (16)
+
 const int max_cost = numeric_limits<int>::max();
 const float max_heuristic = numeric_limits<float>::max();
 const float max_rhs = numeric_limits<float>::max();
 
 
-// Node struct
-typedef struct node {
-	int x, y;
-	/*
-	 * Using final bit of cost to store occupancy(1 if occupied and 0
-	 * otherwise). Final bit is unused becasue the blocks are stored
-	 * in units of 2. Also, since units of 2, messing with final bit
-	 * will still allow correct comparision. Finally, we can use "&"
-	 * to get occupancy.
-	 */
-	unsigned int cost;
-	float heuristic;
-	float rhs;
-} node_t;
-
-
-// Creating a node wrapper/api class
-class CNode {
-public:
-	// Functions
-	static void initialize_node(node_t*, int, bool, int);
-	static bool get_occupancy(node_t*);
-	static void set_occupancy(node_t*, bool);
-	static int get_cost(node_t*);
-	static void set_cost(node_t*, int);
-	static void set_cost_and_occupancy(node_t*, int, bool);
-	static float get_heuristic(node_t*);
-	static void set_heuristic(node_t*, float);
-	static bool nodeCompare(node_t*, node_t*);
-};
+// Neighbor of a node as produced by NodeGrid::neighbors
+typedef struct neighbor {
+	int index;
+	int cost;
+} neighbor_t;
 
 
-// For easier use/debugging of a node map
-class NodeMap {
-public:
-	static node_t** initialize_node_map(int, int, bool**, int, int);
-	static void free_node_map(node_t**);
-	static void print_cost_matrix(node_t**, int, int);
-	static void print_occupancy_matrix(node_t**, int, int);
-	static void print_heuristic_matrix(node_t**, int, int);
-	static bool outOfBounds(node_t**, int, int, int, int);
-	static vector<node*> get_neighbors(node_t**, int, int, int, int);
-	static vector<tuple<int, int>> trace_path(node_t**, int, int, int, int);
-	static void print_generated_path(node_t**, vector<tuple<int, int>>, int, int);
+/*
+ * Cost tables for NodeGrid::neighbors. costs[direction] is the cost of a move
+ * in that direction: the first 4 directions are straight moves and the last 4
+ * are diagonals (see NodeGrid::offsets). The planners use octile costs, where
+ * 10:14 approximates the 1:sqrt(2) length of straight and diagonal moves in
+ * integers, so paths are priced by the distance actually flown.
+ */
+struct octile_costs {
+	static constexpr int costs[8] = { STRAIGHT_COST, STRAIGHT_COST, STRAIGHT_COST, STRAIGHT_COST,
+		DIAGONAL_COST, DIAGONAL_COST, DIAGONAL_COST, DIAGONAL_COST };
 };
 
-
-// For general priority queue syntax purposes
-struct nodeComp {
-	bool operator()(const node_t* n1, const node_t* n2) {
-		return CNode::nodeCompare((node_t*)n1, (node_t*)n2);
-	}
+// Every move costing the same
+struct uniform_costs {
+	static constexpr int costs[8] = { COST, COST, COST, COST, COST, COST, COST, COST };
 };
 
 
-// A Star class
-class AStar {
+/*
+ * Flat structure-of-arrays node store. The grid is padded with a border of
+ * occupied nodes one cell wide, and node (row, col) lives at index
+ * (row + 1) * (cols + 2) + (col + 1) in every array, so coordinates are
+ * implied by the index and every neighbor of an in-bounds node has a valid
+ * index. All arrays share one allocation and each one starts on a cache line.
+ * Occupancy is kept as a bitset instead of in the cost's final bit, and a
+ * grid built from another grid reads that grid's bitset instead of copying it.
+ *
+ * Each node is stamped with the search generation that last initialized it.
+ * begin_search() bumps the generation, which makes every node stale at once;
+ * a stale node is reinitialized by visit() the first time a search reaches
+ * it, so a search only pays for the nodes it touches.
+ */
+class NodeGrid {
 private:
 	// Attributes
-	node_t** node_map;
-	int rows, cols, start_x, start_y, goal_x, goal_y;
-	priority_queue<node_t*, vector<node_t*>, nodeComp> pq;
-	vector<tuple<int, int>> path;
+	int rows, cols, stride, num_nodes;
+	int offsets[8];
+	unsigned int generation;
+	unsigned int* stamps;
+	bool owns_occupancy;
+	void* block;
 
 	// Helper functions
-	float get_heuristic(int x_i, int y_i, int x_f, int y_f);
-	void initializePriorityQueue();
-	node_t* pop_min();
-	bool compute();
+	void set_dimensions(int rows, int cols);
+	void allocate(bool own_occupancy);
 
 public:
+	// Per-node arrays
+	int* g;
+	float* rhs;
+	float* heuristic;
+	int* parents;
+	uint64_t* occupancy;
+
 	// Constructors
-	AStar(bool** occ_matrix, int rows, int cols);
-	AStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+	NodeGrid(int rows, int cols, bool** occ_map);
+	explicit NodeGrid(const NodeGrid* map);
+	NodeGrid(const NodeGrid&);
+	NodeGrid& operator=(const NodeGrid&);
+	~NodeGrid();
+
+	// Indexing
+	inline int index(int row, int col) { return ((row + 1) * stride) + col + 1; }
+	inline int row_of(int index) { return (index / stride) - 1; }
+	inline int col_of(int index) { return (index % stride) - 1; }
+	inline bool outOfBounds(int row, int col) { return (row < 0) || (col < 0) || (row >= rows) || (col >= cols); }
+
+	// Occupancy
+	inline bool get_occupancy(int index) { return (occupancy[index >> 6] >> (index & 63)) & 1; }
+	inline void set_occupancy(int index, bool occupied) {
+		uint64_t bit = (uint64_t) 1 << (index & 63);
+		occupancy[index >> 6] = occupied ? (occupancy[index >> 6] | bit) : (occupancy[index >> 6] & ~bit);
+	}
+	bool range_occupied(int first, int last);
+	bool line_of_sight(int from, int to);
+
+	// Search generations
+	inline bool visited(int index) { return stamps[index] == generation; }
+	inline void visit(int index) {
+		if (stamps[index] != generation) {
+			stamps[index] = generation;
+			g[index] = max_cost;
+			parents[index] = -1;
+			rhs[index] = max_rhs;
+			heuristic[index] = max_heuristic;
+		}
+	}
+	void begin_search();
+
+	/*
+	 * Allocation-free iteration over the unoccupied neighbors of a node:
+	 *     for (neighbor_t neighbor : grid.neighbors<8, octile_costs>(node))
+	 * connectivity is 4 (straight moves only) or 8. Thanks to the occupied
+	 * border, the only check per direction is a single occupancy bit.
+	 */
+	template <int connectivity, typename cost_table>
+	class NeighborRange {
+		static_assert((connectivity == 4) || (connectivity == 8), "Connectivity must be 4 or 8");
+		NodeGrid* grid;
+		int node;
+
+	public:
+		class iterator {
+			NodeGrid* grid;
+			int node, direction;
+
+			// Moves on to the next direction whose neighbor is unoccupied
+			inline void skip_occupied() {
+				while ((direction < connectivity) && grid->get_occupancy(node + grid->offsets[direction])) {
+					direction++;
+				}
+			}
+
+		public:
+			inline iterator(NodeGrid* grid, int node, int direction) : grid(grid), node(node), direction(direction) {
+				skip_occupied();
+			}
+			inline neighbor_t operator*() const {
+				return { node + grid->offsets[direction], cost_table::costs[direction] };
+			}
+			inline iterator& operator++() {
+				direction++;
+				skip_occupied();
+				return *this;
+			}
+			inline bool operator!=(const iterator& other) const { return direction != other.direction; }
+		};
+
+		inline NeighborRange(NodeGrid* grid, int node) : grid(grid), node(node) {}
+		inline iterator begin() const { return iterator(grid, node, 0); }
+		inline iterator end() const { return iterator(grid, node, connectivity); }
+	};
+
+	template <int connectivity = 8, typename cost_table = octile_costs>
+	inline NeighborRange<connectivity, cost_table> neighbors(int node) {
+		return NeighborRange<connectivity, cost_table>(this, node);
+	}
 
 	// API
-	node_t** get_node_map();
-	vector<tuple<int, int>> generate_path();
-	bool update_occupancy_map(bool **);
+	void reset();
+	int get_rows();
+	int get_cols();
+	int get_num_nodes();
+	size_t get_memory_usage();
+	vector<tuple<int, int>> trace_path(int goal_index);
+	static int get_path_cost(int start_x, int start_y, const vector<tuple<int, int>>& path);
+	static float get_path_length(int start_x, int start_y, const vector<tuple<int, int>>& path);
+	void print_cost_matrix();
+	void print_occupancy_matrix();
+	void print_heuristic_matrix();
+	void print_generated_path(vector<tuple<int, int>>);
 };
 
 
-// Custom priority queue
+// Priority of a queued node; compared by k1 first and then by k2
+typedef struct pq_key {
+	float k1, k2;
+} pq_key_t;
+
+
+/*
+ * Custom priority queue. Indexed binary heap over node indices: the slot of
+ * every queued index is kept in a lookup array, so find, contains, remove and
+ * key updates are O(1)/O(log n) instead of a linear scan. Since each index is
+ * queued at most once, a queue built for num_nodes indices never reallocates.
+ * Entries are ordered by a two-part key.
+ */
 class NodePriorityQueue {
 private:
 	// Attributes
-	int size, insertIndex;
-	node_t** nodes;
+	int size, insertIndex, numIndices;
+	int* nodes;
+	pq_key_t* keys;
+	int* slots;
 
 	// Helper functions
 	inline void swap(int, int);
 	inline int getNextSize();
-	inline int getPrevSize();
 	inline int getParentIndex(int);
 	inline int getLeftChildIndex(int);
 	inline int getRightChildIndex(int);
@@ -139,37 +241,249 @@ private:
 	inline int getSmallerElement(int, int);
 	inline int getSmallerChild(int);
 	inline int getLargerChild(int);
+	void reserveIndex(int);
 	void bubbleUp(int);
 	void bubbleDown(int);
 	void heapify();
 	void heapify_helper(int);
+	void sift(int);
 
 public:
 	// Constructors
 	NodePriorityQueue();
-	NodePriorityQueue(int, node_t**);
+	NodePriorityQueue(int);
+	NodePriorityQueue(int, int*, pq_key_t*);
+	NodePriorityQueue(const NodePriorityQueue&);
+	NodePriorityQueue& operator=(const NodePriorityQueue&);
+	~NodePriorityQueue();
 
 	// API Functions
+	static bool keyLess(pq_key_t, pq_key_t);
 	bool isEmpty();
-	void push(node_t*);
-	node_t* pop();
-	int find(node_t*);
-	void update_node_cost(node_t*, int);
+	void push(int, pq_key_t);
+	int pop();
+	int top();
+	pq_key_t top_key();
+	int find(int);
+	bool contains(int);
+	bool remove(int);
+	void update_key(int, pq_key_t);
+	void decrease_key(int, pq_key_t);
+	void clear();
 	int get_size();
 	void print_heap();
 };
 
 
-// Defines another approach to path planning
+/*
+ * Monotone bucket queue (Dial's algorithm) over node indices with small
+ * non-negative integer keys. Queued keys always fit in a ring of buckets
+ * starting at the smallest one, and each bucket is an intrusive doubly
+ * linked list threaded through per-index arrays, so push, pop, remove and
+ * key updates are O(1) as long as the keys move forward by a bounded amount,
+ * as they do in Dijkstra and in A* with a consistent integer heuristic. The
+ * ring grows if a key falls outside it. Ties pop in LIFO order.
+ */
+class BucketQueue {
+private:
+	// Attributes
+	int size, numIndices, numBuckets, cursor, maxKey;
+	int* heads;
+	int* next;
+	int* prev;
+	int* keys;
+
+	// Helper functions
+	inline void link(int, int);
+	inline void unlink(int);
+	inline int findBucket();
+	void reserveIndex(int);
+	void resize(int);
+
+public:
+	// Constructors
+	BucketQueue();
+	BucketQueue(int);
+	BucketQueue(const BucketQueue&);
+	BucketQueue& operator=(const BucketQueue&);
+	~BucketQueue();
+
+	// API Functions
+	bool isEmpty();
+	void push(int, int);
+	void push(int, pq_key_t);
+	int pop();
+	int top();
+	int top_key();
+	bool contains(int);
+	bool remove(int);
+	void decrease_key(int, pq_key_t);
+	void clear();
+	int get_size();
+};
+
+
+// Which queue a planner that supports both keeps its open list in
+typedef enum queue_type {
+	QUEUE_BINARY_HEAP,
+	QUEUE_BUCKET
+} queue_type_t;
+
+
+/*
+ * Where a resumable search stands after a call to step. Searches stay in
+ * progress until they either reach the goal or run out of nodes to expand.
+ */
+typedef enum search_status {
+	SEARCH_IN_PROGRESS,
+	SEARCH_FOUND,
+	SEARCH_UNREACHABLE
+} search_status_t;
+
+
+/*
+ * Bookkeeping of one resumable best-first search run by the engine in
+ * grid_search.hpp. best_node is the expanded node ranked closest to the goal,
+ * which is where a partial path leads.
+ */
+typedef struct search_state {
+	int goal, best_node;
+	float best_rank;
+	int expansions;
+	search_status_t status;
+} search_state_t;
+
+
+/*
+ * ALT landmarks: exact costs from a few landmark cells to every cell, kept
+ * for repeated queries on one map. By the triangle inequality, the cost
+ * between any cell and a goal is at least |d(L, goal) - d(L, cell)| for every
+ * landmark L, which is far tighter than octile distance behind walls (see
+ * landmark_heuristic). Landmarks are picked farthest first: each is the cell
+ * with the largest cost to the landmarks picked before it. Costs are stored
+ * node major, num_landmarks per node, so a heuristic lookup reads one line.
+ *
+ * Occupancy changes are handled per LANDMARK_TILE_W wide tile. Freed cells
+ * can only lower costs, so a Dijkstra seeded at just those cells lowers the
+ * tables until costs stop falling. Blocked cells can only raise costs, so the
+ * tables are left alone: they stay a consistent, if looser, bound. Once more
+ * than 1 / LANDMARK_REBUILD_FRACTION of the tiles have been blocked, the
+ * landmarks are picked and computed again.
+ */
+class Landmarks {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, num_landmarks;
+	int expansions;
+	vector<int> landmarks;
+	vector<int> costs;
+	vector<bool> blocked_tiles;
+	int num_blocked_tiles;
+	BucketQueue bq;
+
+	// Helper functions
+	void build();
+	void search_from(int source);
+	void lower_costs(const vector<int>& seeds);
+	void mark_blocked(int row, int col);
+
+public:
+	// Constructors
+	Landmarks(bool** occ_matrix, int rows, int cols, int num_landmarks);
+	Landmarks(const NodeGrid& map, int num_landmarks);
+
+	// Indexing and lookup, where a landmark's cost is max_cost if it can't reach the node
+	inline int index(int row, int col) { return grid.index(row, col); }
+	inline const int* get_costs(int index) { return &costs[(size_t) index * num_landmarks]; }
+
+	// API
+	NodeGrid* get_node_map();
+	int get_num_landmarks();
+	tuple<int, int> get_landmark(int);
+	int get_cost(int landmark, int x, int y);
+	void update_occupancy(int row, int col, bool occupied);
+	void update_occupancy_map(bool**);
+	void rebuild();
+	int get_expansions();
+};
+
+
+// A Star class
+class AStar {
+private:
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	search_state_t search;
+	queue_type_t queue_type;
+	NodePriorityQueue pq;
+	BucketQueue bq;
+	vector<tuple<int, int>> path;
+
+	// Anytime (ARA*) state
+	float epsilon, suboptimality_bound;
+	unsigned int iteration;
+	vector<unsigned int> closed;
+	vector<int> incons;
+
+	// ALT landmarks (none by default)
+	unique_ptr<Landmarks> landmarks;
+
+	// Helper functions
+	bool compute();
+	bool improve_path(steady_clock::time_point deadline);
+	float reweight_open();
+
+public:
+	// Constructors
+	AStar(bool** occ_matrix, int rows, int cols);
+	AStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+
+	// API
+	NodeGrid* get_node_map();
+	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	vector<tuple<int, int>> generate_path(steady_clock::time_point deadline, float initial_epsilon, float epsilon_step);
+	float get_suboptimality_bound();
+	void set_queue_type(queue_type_t);
+	void set_landmarks(int num_landmarks);
+	Landmarks* get_landmarks();
+	void start_search();
+	void start_search(int start_x, int start_y, int goal_x, int goal_y);
+	search_status_t step(int max_expansions);
+	search_status_t get_status();
+	vector<tuple<int, int>> get_partial_path();
+	bool update_occupancy_map(bool **);
+	int get_expansions();
+};
+
+
+/*
+ * D* Lite: searches backwards from the goal and keeps its g/rhs values between
+ * calls, so after the start moves or some cells change occupancy only the
+ * affected nodes are repaired. The grid's g array holds the cost to the goal
+ * and its rhs array holds the one-step lookahead cost.
+ */
 class DStar {
 	// Attributes
-	node_t** node_map;
+	NodeGrid grid;
 	int rows, cols, start_x, start_y, goal_x, goal_y;
+	float km;
+	bool initialized;
+	int expansions;
+	search_status_t status;
 	NodePriorityQueue pq;
 
 	// Helper functions
 	bool compute();
+	void initialize();
+	vector<tuple<int, int>> descend(bool keep_prefix);
 	float get_heuristic(int x_i, int y_i, int x_f, int y_f);
+	float get_g(int);
+	void set_g(int, float);
+	pq_key_t calculate_key(int);
+	float lookahead_cost(int);
+	void update_vertex(int);
 
 public:
 	// Constructors
@@ -177,9 +491,309 @@ public:
 	DStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
 
 	// API
-	node_t** get_node_map();
+	NodeGrid* get_node_map();
+	vector<tuple<int, int>> generate_path();
+	void update_occupancy_map(bool**);
+	void update_occupancy(int row, int col, bool occupied);
+	void update_start(int start_x, int start_y);
+	search_status_t step(int max_expansions);
+	search_status_t get_status();
+	vector<tuple<int, int>> get_partial_path();
+	int get_expansions();
+};
+
+
+/*
+ * Jump Point Search: A* over the 8-connected octile-cost grid that prunes
+ * symmetric expansions and only queues jump points, found by running along
+ * straight and diagonal lines until a forced neighbor or the goal shows up.
+ */
+class JPS {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	int expansions;
+	NodePriorityQueue pq;
+
+	// Helper functions
+	float get_heuristic(int x_i, int y_i, int x_f, int y_f);
+	inline bool is_free(int x, int y);
+	bool jump(int x, int y, int dx, int dy, int* jump_x, int* jump_y);
+	void add_successor(int of_interest, int dx, int dy);
+	bool compute();
+	vector<tuple<int, int>> trace_path();
+
+public:
+	// Constructors
+	JPS(bool** occ_matrix, int rows, int cols);
+	JPS(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+
+	// API
+	NodeGrid* get_node_map();
+	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	int get_expansions();
+};
+
+
+/*
+ * Theta*: A* whose nodes may take their parent's parent as their own parent
+ * whenever it can see them, so paths bend only at obstacle corners instead
+ * of every 45 degrees, and come back as a few waypoints (the cells where the
+ * path turns) instead of every cell. Move costs are straight-line distances
+ * in STRAIGHT_COST units, so a diagonal step costs DIAGONAL_COST as usual.
+ * Line of sight is NodeGrid::line_of_sight. Lazy Theta* assumes every node
+ * can see its parent's parent and only checks once the node is expanded,
+ * which takes one check per expansion instead of one per neighbor.
+ */
+class ThetaStar {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	int expansions, sight_checks;
+	bool lazy;
+	unsigned int search_id;
+	vector<unsigned int> closed;
+	NodePriorityQueue pq;
+
+	// Helper functions
+	inline int get_distance(int from, int to);
+	inline bool has_sight(int from, int to);
+	void relax(int of_interest, int neighbor);
+	void set_vertex(int of_interest);
+	bool compute();
+
+public:
+	// Constructors
+	ThetaStar(bool** occ_matrix, int rows, int cols);
+	ThetaStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+
+	// API
+	NodeGrid* get_node_map();
 	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	void set_lazy(bool);
+	bool update_occupancy_map(bool**);
+	int get_expansions();
+	int get_sight_checks();
+};
+
+
+/*
+ * Goal-rooted distance field: one backwards Dijkstra from the goal stores the
+ * cost-to-go of every reachable cell, and each cell's parent is the neighbor
+ * to step to next, so a path from any start is read off in O(path length).
+ * Occupancy changes are repaired incrementally in the style of D* Lite
+ * (without a start, so every cell ends up consistent): the grid's rhs array
+ * holds the one-step lookahead cost and only the affected cells are redone.
+ */
+class DistanceField {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, goal_x, goal_y;
+	int expansions;
+	NodePriorityQueue pq;
+
+	// Helper functions
+	void compute();
+	float get_g(int);
+	void set_g(int, float);
+	void update_vertex(int);
+	void repair();
+
+public:
+	// Constructors
+	DistanceField(bool** occ_matrix, int rows, int cols, int goal_x, int goal_y);
+
+	// API
+	NodeGrid* get_node_map();
+	int get_cost_to_go(int x, int y);
+	tuple<int, int> get_direction(int x, int y);
+	vector<tuple<int, int>> generate_path(int start_x, int start_y);
+	void update_occupancy(int row, int col, bool occupied);
+	void update_occupancy_map(bool**);
+	int get_expansions();
+};
+
+
+/*
+ * Bidirectional A*: a forward search from the start and a backward search
+ * from the goal, each with its own grid, bucket queue and octile heuristic
+ * towards the other end. Whenever a node's cost improves in one direction
+ * and the other direction has reached it too, the path through it is a
+ * candidate meeting. The search stops once either frontier's smallest
+ * g + h is no less than the best meeting's cost, which with consistent
+ * heuristics means no cheaper path is left, and the path is stitched
+ * together at the meeting node. Threaded, the backward search runs on a
+ * second thread and the directions only share published costs.
+ */
+class BidirectionalAStar {
+	// Attributes
+	NodeGrid forward, backward;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	int expansions, meeting;
+	bool threaded;
+	unsigned int search_id;
+	BucketQueue forward_queue, backward_queue;
+	vector<uint64_t> forward_labels, backward_labels;
+	vector<tuple<int, int>> path;
+
+	// Helper functions
+	void begin_search();
+	bool compute();
+	bool compute_threaded();
+	vector<tuple<int, int>> stitch_path();
+
+public:
+	// Constructors
+	BidirectionalAStar(bool** occ_matrix, int rows, int cols);
+	BidirectionalAStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+
+	// API
+	NodeGrid* get_node_map();
+	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	void set_threaded(bool);
+	bool update_occupancy_map(bool**);
+	int get_expansions();
+};
+
+
+// One start/goal pair of a batch
+typedef struct path_query {
+	int start_x, start_y, goal_x, goal_y;
+} path_query_t;
+
+// Outcome of one query of a batch: the path (empty if there's none) and how it was found
+typedef struct path_result {
+	vector<tuple<int, int>> path;
+	int cost;
+	int expansions;
+	long long microseconds;
+	int worker;
+} path_result_t;
+
+
+/*
+ * Plans batches of independent queries on a pool of worker threads over one
+ * shared occupancy map. Each worker searches on its own NodeGrid, and all
+ * of them read the map's occupancy bitset, so the map is stored once no
+ * matter how many workers there are, and workers never write to anything
+ * another worker reads. Queries are handed out one at a time from a shared counter, which
+ * keeps the workers busy when some queries take much longer than others.
+ * Searches are integer octile A* on bucket queues, like AStar with
+ * QUEUE_BUCKET, so the paths cost the same as AStar's.
+ */
+class BatchPlanner {
+	// Attributes
+	NodeGrid map;
+	int rows, cols, num_threads;
+	vector<thread> workers;
+	mutex lock;
+	condition_variable work_ready, batch_done;
+	const vector<path_query_t>* batch;
+	vector<path_result_t>* results;
+	atomic<int> next_query;
+	unsigned int batch_id;
+	int busy_workers;
+	bool stopping;
+
+	// Helper functions
+	void run_worker(int worker);
+
+public:
+	// Constructors
+	BatchPlanner(bool** occ_matrix, int rows, int cols);
+	BatchPlanner(bool** occ_matrix, int rows, int cols, int num_threads);
+	~BatchPlanner();
+
+	// API
+	NodeGrid* get_node_map();
+	vector<path_result_t> plan(const vector<path_query_t>& queries);
+	void update_occupancy_map(bool**);
+	int get_num_threads();
+};
+
+
+// Lock-free ring that ParallelAStar's workers send nodes through, defined in hda_star.cpp
+class MessageRing;
+
+/*
+ * Hash-distributed A* (HDA*) for single long queries. Every node belongs to
+ * one worker thread, picked by hashing the 16x16 block of cells it lies in,
+ * and only its owner ever reads or writes its g, parent and heuristic in the
+ * shared grid. A worker expands its own open list and sends each neighbor
+ * that belongs to another worker to it as a message through a lock-free
+ * single-producer single-consumer ring. Expansion isn't globally ordered,
+ * so a node can be reopened, but once every worker is idle with nothing
+ * queued below the best goal cost found and no message is in flight, that
+ * cost is optimal. The path costs the same as AStar's.
+ */
+class ParallelAStar {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, start_x, start_y, goal_x, goal_y;
+	int num_threads;
+	unique_ptr<MessageRing[]> rings;
+	int expansions;
+	long long messages;
+	vector<tuple<int, int>> path;
+
+	// Helper functions
+	bool compute();
+
+public:
+	// Constructors
+	ParallelAStar(bool** occ_matrix, int rows, int cols);
+	ParallelAStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
+	~ParallelAStar();
+
+	// API
+	NodeGrid* get_node_map();
+	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	void set_num_threads(int);
+	int get_num_threads();
+	bool update_occupancy_map(bool**);
+	int get_expansions();
+	long long get_messages();
+};
+
+
+/*
+ * Delta-stepping: a parallel single-source shortest path search that fills
+ * in the cost between a source and every reachable cell, like a
+ * DistanceField build, across several threads. Tentative costs are kept in
+ * buckets delta wide. All nodes in the lowest non-empty bucket are relaxed
+ * in parallel along their light moves (cost <= delta) until the bucket
+ * stops refilling, then along their heavy moves, and then the next bucket
+ * is taken up. Threads lower costs with an atomic compare-and-swap directly
+ * in the grid's g array, which becomes the flat distance array. Costs come
+ * out the same as single-threaded Dijkstra's since only the order of the
+ * relaxations changes.
+ */
+class DeltaStepping {
+	// Attributes
+	NodeGrid grid;
+	int rows, cols, source_x, source_y;
+	int num_threads, delta;
+	int phases;
+
+	// Helper functions
+	void compute();
+
+public:
+	// Constructors
+	DeltaStepping(bool** occ_matrix, int rows, int cols, int source_x, int source_y);
+	DeltaStepping(bool** occ_matrix, int rows, int cols, int source_x, int source_y, int num_threads, int delta);
+
+	// API
+	NodeGrid* get_node_map();
+	int get_cost_to_go(int x, int y);
+	const int* get_distances();
+	void set_source(int source_x, int source_y);
 	void update_occupancy_map(bool**);
+	int get_phases();
 };
 
 
@@ -198,6 +812,23 @@ void test_DStar(const char* out_file_name, bool input_file_exists,
 	const char* input_file_name, bool create_input_file,
 	const char* new_input_file_name, int nrows, int ncols,
 	double density);
+void benchmark_DStar_replanning(int nrows, int ncols, double density, int num_edits);
+void test_JPS(int nrows, int ncols, double density, int num_trials);
+void benchmark_node_grid(int nrows, int ncols, double density);
+void benchmark_workspace_reuse(int nrows, int ncols, double density, int num_plans);
+void test_ARAStar(int nrows, int ncols, double density, int deadline_us);
+void test_step_search(int nrows, int ncols, double density, int slice_size);
+void benchmark_distance_field(int nrows, int ncols, double density, int num_starts, int num_edits);
+void benchmark_queues(int nrows, int ncols, double density);
+void benchmark_search_policies(int nrows, int ncols, double density);
+void benchmark_bidirectional(int nrows, int ncols, int num_queries);
+void benchmark_bidirectional_tile_map(int width, int height, double density, int num_queries);
+void benchmark_batch_planner(int nrows, int ncols, double density, int num_queries);
+void benchmark_parallel_astar(int nrows, int ncols, double density);
+void benchmark_delta_stepping(int nrows, int ncols, double density);
+void benchmark_landmarks(int nrows, int ncols, double density, int num_queries, int num_edits);
+void benchmark_theta_star(int nrows, int ncols, double density, int num_queries);
+int test_pthfnd();
 
 // random_maze_generator.cpp
 bool** create_maze(int nrows, int ncols, double density);
@@ -207,16 +838,18 @@ bool** create_maze_file(const char* file_name, int nrows, int ncols,
 bool** create_clustered_maze_file(const char* file_name, int nrows, int ncols,
 	double density);
 bool** read_maze_file(FILE*);
-void write_maze_sol(FILE*, node_t**, vector<tuple<int, int>>, int, int);
+void write_maze_sol(FILE*, NodeGrid*, vector<tuple<int, int>>, int, int);
 
 
 // Defines another approach to path planning
 class Dijkstra {
 	// Attributes
-	node** node_map;
-	unordered_set<node_t*> explored;
+	NodeGrid grid;
 	int rows, cols, start_x, start_y, goal_x, goal_y;
+	search_state_t search;
+	queue_type_t queue_type;
 	NodePriorityQueue pq;
+	BucketQueue bq;
 
 	// Helper functions
 	bool compute();
@@ -227,6 +860,13 @@ public:
 	Dijkstra(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y);
 
 	// API
-	node_t** get_node_map();
+	NodeGrid* get_node_map();
 	vector<tuple<int, int>> generate_path();
+	vector<tuple<int, int>> generate_path(int start_x, int start_y, int goal_x, int goal_y);
+	void set_queue_type(queue_type_t);
+	void start_search();
+	void start_search(int start_x, int start_y, int goal_x, int goal_y);
+	search_status_t step(int max_expansions);
+	search_status_t get_status();
+	vector<tuple<int, int>> get_partial_path();
 };
\ No newline at end of file
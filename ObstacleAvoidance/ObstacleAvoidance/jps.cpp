@@ -0,0 +1,243 @@
+// Includes
+#include "header.hh"
+
+
+// Defining JPS Class
+// Gets the octile distance from given point to end, which is exact on an empty grid
+float JPS::get_heuristic(int x_i, int y_i, int x_f, int y_f) {
+	int d_x = abs(x_f - x_i), d_y = abs(y_f - y_i);
+	int diagonals = min(d_x, d_y);
+	return (float) ((DIAGONAL_COST * diagonals) + (STRAIGHT_COST * (max(d_x, d_y) - diagonals)));
+}
+
+// Returns whether a node can be moved onto (the occupied border covers going out of bounds)
+inline bool JPS::is_free(int x, int y) {
+	return !grid.get_occupancy(grid.index(x, y));
+}
+
+/*
+ * Steps from (x, y) in direction (dx, dy) until reaching a jump point: the
+ * goal, a node with a forced neighbor, or (for diagonal moves) a node from
+ * which a straight jump finds a jump point. Returns false if the run hits an
+ * obstacle or the edge of the map first.
+ */
+bool JPS::jump(int x, int y, int dx, int dy, int* jump_x, int* jump_y) {
+	while (true) {
+		x += dx;
+		y += dy;
+		if (!is_free(x, y)) {
+			return false;
+		}
+		if ((x == goal_x) && (y == goal_y)) {
+			break;
+		}
+
+		if ((dx != 0) && (dy != 0)) {
+			// Diagonal move: forced neighbors appear when a trailing side is blocked
+			if ((!is_free(x - dx, y) && is_free(x - dx, y + dy)) ||
+				(!is_free(x, y - dy) && is_free(x + dx, y - dy))) {
+				break;
+			}
+
+			// Diagonal nodes are jump points if either straight component leads to one
+			int tmp_x, tmp_y;
+			if (jump(x, y, dx, 0, &tmp_x, &tmp_y) || jump(x, y, 0, dy, &tmp_x, &tmp_y)) {
+				break;
+			}
+		}
+		else if (dx != 0) {
+			if ((!is_free(x, y + 1) && is_free(x + dx, y + 1)) ||
+				(!is_free(x, y - 1) && is_free(x + dx, y - 1))) {
+				break;
+			}
+		}
+		else {
+			if ((!is_free(x + 1, y) && is_free(x + 1, y + dy)) ||
+				(!is_free(x - 1, y) && is_free(x - 1, y + dy))) {
+				break;
+			}
+		}
+	}
+
+	*jump_x = x;
+	*jump_y = y;
+	return true;
+}
+
+// Jumps from a node in the given direction and relaxes the jump point found, if any
+void JPS::add_successor(int of_interest, int dx, int dy) {
+	int x = grid.row_of(of_interest), y = grid.col_of(of_interest);
+	int jump_x, jump_y;
+	if (!jump(x, y, dx, dy, &jump_x, &jump_y)) {
+		return;
+	}
+
+	// A jump runs in a single direction, so all of its steps cost the same
+	int steps = max(abs(jump_x - x), abs(jump_y - y));
+	int new_cost = grid.g[of_interest] + (steps * (((jump_x != x) && (jump_y != y)) ? DIAGONAL_COST : STRAIGHT_COST));
+	int successor = grid.index(jump_x, jump_y);
+	grid.visit(successor);
+	if (new_cost < grid.g[successor]) {
+		if (grid.g[successor] == max_cost) {
+			grid.heuristic[successor] = get_heuristic(jump_x, jump_y, goal_x, goal_y);
+		}
+		grid.g[successor] = new_cost;
+		grid.parents[successor] = of_interest;
+		pq.push(successor, { grid.heuristic[successor] + new_cost, (float) new_cost });
+	}
+}
+
+// Performs necessary computations, stores them in node, & returns if path was found
+bool JPS::compute() {
+	// Nodes left over from the last search go stale instead of being reset
+	grid.begin_search();
+	pq.clear();
+	expansions = 0;
+
+	int start = grid.index(start_x, start_y);
+	grid.visit(start);
+	grid.g[start] = 0;
+	grid.heuristic[start] = get_heuristic(start_x, start_y, goal_x, goal_y);
+	grid.parents[start] = -1;
+	pq.push(start, { grid.heuristic[start], 0 });
+
+	while (!pq.isEmpty()) {
+		int of_interest = pq.pop();
+		int x = grid.row_of(of_interest), y = grid.col_of(of_interest);
+		expansions++;
+
+		// Checking if destination reached
+		if ((x == goal_x) && (y == goal_y)) {
+			return true;
+		}
+
+		int parent = grid.parents[of_interest];
+		if (parent == -1) {
+			// The start has no direction of travel, so nothing is pruned
+			for (int dx = -1; dx <= 1; dx++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					if ((dx != 0) || (dy != 0)) {
+						add_successor(of_interest, dx, dy);
+					}
+				}
+			}
+			continue;
+		}
+
+		// Direction of travel into this node
+		int parent_x = grid.row_of(parent), parent_y = grid.col_of(parent);
+		int dx = (x > parent_x) - (x < parent_x);
+		int dy = (y > parent_y) - (y < parent_y);
+
+		if ((dx != 0) && (dy != 0)) {
+			// Natural neighbors of a diagonal move
+			add_successor(of_interest, dx, 0);
+			add_successor(of_interest, 0, dy);
+			add_successor(of_interest, dx, dy);
+
+			// Forced neighbors
+			if (!is_free(x - dx, y)) {
+				add_successor(of_interest, -dx, dy);
+			}
+			if (!is_free(x, y - dy)) {
+				add_successor(of_interest, dx, -dy);
+			}
+		}
+		else if (dx != 0) {
+			add_successor(of_interest, dx, 0);
+			if (!is_free(x, y + 1)) {
+				add_successor(of_interest, dx, 1);
+			}
+			if (!is_free(x, y - 1)) {
+				add_successor(of_interest, dx, -1);
+			}
+		}
+		else {
+			add_successor(of_interest, 0, dy);
+			if (!is_free(x + 1, y)) {
+				add_successor(of_interest, 1, dy);
+			}
+			if (!is_free(x - 1, y)) {
+				add_successor(of_interest, -1, dy);
+			}
+		}
+	}
+
+	return false;
+}
+
+// Walks the parents back from the goal, filling in the cells between jump points
+vector<tuple<int, int>> JPS::trace_path() {
+	vector<tuple<int, int>> path;
+	int index = grid.index(goal_x, goal_y);
+	while (grid.parents[index] != -1) {
+		int x = grid.row_of(index), y = grid.col_of(index);
+		int parent_x = grid.row_of(grid.parents[index]), parent_y = grid.col_of(grid.parents[index]);
+		int dx = (parent_x > x) - (parent_x < x);
+		int dy = (parent_y > y) - (parent_y < y);
+		while ((x != parent_x) || (y != parent_y)) {
+			path.push_back(make_tuple(x, y));
+			x += dx;
+			y += dy;
+		}
+		index = grid.parents[index];
+	}
+
+	reverse(path.begin(), path.end());
+	return path;
+}
+
+// constructors
+JPS::JPS(bool** occ_matrix, int rows, int cols) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
+	// By default, setting bottom left as start and top right corner as goal
+	start_x = 0;
+	start_y = 0;
+	goal_x = rows - 1;
+	goal_y = cols - 1;
+	this->rows = rows;
+	this->cols = cols;
+	this->expansions = 0;
+}
+
+JPS::JPS(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix), pq(grid.get_num_nodes()) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	this->rows = rows;
+	this->cols = cols;
+	this->expansions = 0;
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* JPS::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of jump points expanded during the last search
+int JPS::get_expansions() {
+	return this->expansions;
+}
+
+/*
+ * Searches over jump points only and if a path exists, returns every cell
+ * along it (start --> finish, excluding the start like NodeGrid::trace_path).
+ */
+vector<tuple<int, int>> JPS::generate_path() {
+	vector<tuple<int, int>> path;
+	if (compute()) {
+		path = trace_path();
+	}
+	return path;
+}
+
+// Plans between a new start and goal, reusing this instance's grid and pq
+vector<tuple<int, int>> JPS::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
@@ -0,0 +1,224 @@
+// Includes
+#include "grid_search.hpp"
+
+// Width of the tiles that occupancy changes are tracked in
+#define LANDMARK_TILE_W (16)
+
+// The tables are rebuilt once more than 1 / LANDMARK_REBUILD_FRACTION of the tiles have had cells blocked
+#define LANDMARK_REBUILD_FRACTION (8)
+
+
+// Defining Landmarks Class
+// Constructor, which picks the landmarks and computes their costs right away
+Landmarks::Landmarks(bool** occ_matrix, int rows, int cols, int num_landmarks) :
+	grid(rows, cols, occ_matrix), bq(grid.get_num_nodes()) {
+	this->rows = rows;
+	this->cols = cols;
+	this->num_landmarks = min(max(1, num_landmarks), MAX_LANDMARKS);
+	this->blocked_tiles.assign((size_t) ((rows + LANDMARK_TILE_W - 1) / LANDMARK_TILE_W) *
+		((cols + LANDMARK_TILE_W - 1) / LANDMARK_TILE_W), false);
+	build();
+}
+
+// Constructor from a planner's grid, whose occupancy is copied so later changes can be told apart
+Landmarks::Landmarks(const NodeGrid& map, int num_landmarks) : grid(map), bq(grid.get_num_nodes()) {
+	this->rows = grid.get_rows();
+	this->cols = grid.get_cols();
+	this->num_landmarks = min(max(1, num_landmarks), MAX_LANDMARKS);
+	this->blocked_tiles.assign((size_t) ((rows + LANDMARK_TILE_W - 1) / LANDMARK_TILE_W) *
+		((cols + LANDMARK_TILE_W - 1) / LANDMARK_TILE_W), false);
+	build();
+}
+
+// Runs Dijkstra from a node over every cell it can reach, leaving the costs in the g of the nodes it visits
+void Landmarks::search_from(int source) {
+	search_state_t state;
+	bq.clear();
+	begin_grid_search(grid, bq, state, zero_heuristic<>(0, 0), source, -1);
+	step_grid_search<zero_heuristic<>, 8, octile_costs>(grid, bq, state, zero_heuristic<>(0, 0), max_cost);
+	this->expansions += state.expansions;
+}
+
+/*
+ * Picks the landmarks farthest first and fills in their costs. The first
+ * search runs from an arbitrary free cell only to find the first landmark,
+ * the cell farthest from it. Each landmark's search then lowers every cell's
+ * cost to its nearest landmark, and the next landmark is the cell where that
+ * cost is highest. Fewer landmarks are kept if every reachable cell is one.
+ */
+void Landmarks::build() {
+	int num_nodes = grid.get_num_nodes();
+	landmarks.clear();
+	costs.assign((size_t) num_nodes * num_landmarks, max_cost);
+	fill(blocked_tiles.begin(), blocked_tiles.end(), false);
+	num_blocked_tiles = 0;
+	expansions = 0;
+
+	int next = -1;
+	for (int node = 0; (node < num_nodes) && (next < 0); node++) {
+		if (!grid.get_occupancy(node)) {
+			next = node;
+		}
+	}
+	if (next < 0) {
+		return;
+	}
+
+	vector<int> nearest(num_nodes, max_cost);
+	search_from(next);
+	int farthest = 0;
+	for (int node = 0; node < num_nodes; node++) {
+		if (grid.visited(node) && (grid.g[node] > farthest)) {
+			farthest = grid.g[node];
+			next = node;
+		}
+	}
+
+	while ((int) landmarks.size() < num_landmarks) {
+		int landmark = (int) landmarks.size();
+		landmarks.push_back(next);
+		search_from(next);
+		farthest = 0;
+		for (int node = 0; node < num_nodes; node++) {
+			if (grid.visited(node)) {
+				costs[((size_t) node * num_landmarks) + landmark] = grid.g[node];
+				nearest[node] = min(nearest[node], grid.g[node]);
+				if (nearest[node] > farthest) {
+					farthest = nearest[node];
+					next = node;
+				}
+			}
+		}
+		if (farthest == 0) {
+			break;
+		}
+	}
+}
+
+/*
+ * Lowers every landmark's costs after the seed cells were freed. A seed
+ * takes the cheapest cost through its free neighbors, and anything a lower
+ * cost can improve is relaxed in cost order, so the search stops where costs
+ * stop falling. Afterwards no move costs less than the difference between
+ * the costs at its two ends, which is what keeps the heuristic consistent.
+ */
+void Landmarks::lower_costs(const vector<int>& seeds) {
+	for (int landmark = 0; landmark < (int) landmarks.size(); landmark++) {
+		bq.clear();
+		for (int seed : seeds) {
+			int& seed_cost = costs[((size_t) seed * num_landmarks) + landmark];
+			for (neighbor_t next : grid.neighbors(seed)) {
+				int next_cost = costs[((size_t) next.index * num_landmarks) + landmark];
+				if ((next_cost != max_cost) && (next_cost + next.cost < seed_cost)) {
+					seed_cost = next_cost + next.cost;
+				}
+			}
+			if (seed_cost != max_cost) {
+				bq.push(seed, seed_cost);
+			}
+		}
+
+		while (!bq.isEmpty()) {
+			int of_interest = bq.pop();
+			int cost = costs[((size_t) of_interest * num_landmarks) + landmark];
+			expansions++;
+			for (neighbor_t next : grid.neighbors(of_interest)) {
+				int& next_cost = costs[((size_t) next.index * num_landmarks) + landmark];
+				if (cost + next.cost < next_cost) {
+					next_cost = cost + next.cost;
+					bq.push(next.index, next_cost);
+				}
+			}
+		}
+	}
+}
+
+// Records that the tile holding a cell has had a cell blocked since the last build
+void Landmarks::mark_blocked(int row, int col) {
+	int tile_cols = (cols + LANDMARK_TILE_W - 1) / LANDMARK_TILE_W;
+	int tile = ((row / LANDMARK_TILE_W) * tile_cols) + (col / LANDMARK_TILE_W);
+	if (!blocked_tiles[tile]) {
+		blocked_tiles[tile] = true;
+		num_blocked_tiles++;
+	}
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* Landmarks::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of landmarks picked, which is fewer than asked for on small or enclosed maps
+int Landmarks::get_num_landmarks() {
+	return (int) this->landmarks.size();
+}
+
+// Returns the cell of a landmark
+tuple<int, int> Landmarks::get_landmark(int landmark) {
+	return make_tuple(grid.row_of(landmarks[landmark]), grid.col_of(landmarks[landmark]));
+}
+
+// Returns a landmark's cost to a cell (max_cost if it can't be reached), exact until cells are blocked
+int Landmarks::get_cost(int landmark, int x, int y) {
+	return get_costs(grid.index(x, y))[landmark];
+}
+
+// Changes one cell's occupancy and repairs the tables
+void Landmarks::update_occupancy(int row, int col, bool occupied) {
+	int node = grid.index(row, col);
+	if (grid.get_occupancy(node) == occupied) {
+		return;
+	}
+	grid.set_occupancy(node, occupied);
+	expansions = 0;
+	if (occupied) {
+		mark_blocked(row, col);
+		if (num_blocked_tiles * LANDMARK_REBUILD_FRACTION > (int) blocked_tiles.size()) {
+			build();
+		}
+	}
+	else {
+		lower_costs(vector<int>(1, node));
+	}
+}
+
+/*
+ * Updates the occupancy map, repairing the tables for the freed cells in one
+ * pass and rebuilding them if too many tiles have been blocked since the
+ * last build.
+ */
+void Landmarks::update_occupancy_map(bool** occupancy_map) {
+	vector<int> freed;
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			int node = grid.index(row, col);
+			if (grid.get_occupancy(node) != occupancy_map[row][col]) {
+				grid.set_occupancy(node, occupancy_map[row][col]);
+				if (occupancy_map[row][col]) {
+					mark_blocked(row, col);
+				}
+				else {
+					freed.push_back(node);
+				}
+			}
+		}
+	}
+
+	expansions = 0;
+	if (num_blocked_tiles * LANDMARK_REBUILD_FRACTION > (int) blocked_tiles.size()) {
+		build();
+	}
+	else if (!freed.empty()) {
+		lower_costs(freed);
+	}
+}
+
+// Picks the landmarks again and recomputes their costs from scratch
+void Landmarks::rebuild() {
+	build();
+}
+
+// Returns the number of nodes settled by the last build or repair
+int Landmarks::get_expansions() {
+	return this->expansions;
+}
@@ -154,7 +154,7 @@ namespace maps2 {
 			return info.get_bounds();
 		}
 		~nbrng_tile_linker() override {
-			delete_mixed_tree<tile>(root, info.depth);
+			delete_mixed_tree<nbrng_tile<tile>>(root, info.depth);
 		}
 	};
 
@@ -611,15 +611,17 @@ namespace maps2 {
 		while (next_nbr = nbr_retriever.next_tile()) {
 			// Local coordinates of neighbor, relative to neighborhood around tile
 			local_coords = (nbr_retriever.last_origin() - neighborhood_bounds.min) >> log2_w;
+			// Tiles that only touch the neighborhood's edge aren't neighbors
+			if (local_coords.x < 0 || local_coords.y < 0 || local_coords.x > 2 || local_coords.y > 2) continue;
 			compact_coords = local_coords.x + 3 * local_coords.y;
 			if (compact_coords != 4) {
 				// Link tile to neighbor
-				new_tile->nbrs[compact_coords - (local_coords.x > 4)] = next_nbr;
+				new_tile->nbrs[compact_coords - (compact_coords > 4)] = next_nbr;
 				// Local coordinates of tile, relative to neighbor
 				local_coords = gmtry2i::vector2i(2, 2) - local_coords;
 				compact_coords = local_coords.x + 3 * local_coords.y;
 				// Link neighbor to tile
-				next_nbr->nbrs[compact_coords - (local_coords.x > 4)] = new_tile;
+				next_nbr->nbrs[compact_coords - (compact_coords > 4)] = new_tile;
 			}
 		}
 	}
@@ -1,158 +1,329 @@
 // Imports
 #include "header.hh"
+#include "util/geometry.hpp"
 
 
-// Given number of rows, cols, and occupancy map, initialized nodes per path finding algo.
-node_t** NodeMap::initialize_node_map(int rows, int cols, bool** occ_map, int start_x, int start_y) {
-	node_t** node_map = (node_t**)allocate_2d_arr(rows, cols, sizeof(node_t));
-	if (node_map == NULL) {
-		fprintf(stderr, "Problem allocating memory for the maze.\n");
-		return NULL;
+// Every per-node array starts on its own cache line
+#define CACHE_LINE (64)
+
+// Rounds a byte count up to a whole number of cache lines
+static inline size_t cache_align(size_t bytes) {
+	return (bytes + CACHE_LINE - 1) & ~((size_t) CACHE_LINE - 1);
+}
+
+/*
+ * Sets up the padded layout: one extra column on each side of every row and
+ * one extra row above and below the grid. Neighbor offsets are listed with
+ * the straight moves first and the diagonals last, matching the cost tables.
+ */
+void NodeGrid::set_dimensions(int rows, int cols) {
+	this->rows = rows;
+	this->cols = cols;
+	this->stride = cols + 2;
+	this->num_nodes = (rows + 2) * stride;
+
+	int directions[8][2] = { { -1, 0 }, { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+	for (int direction = 0; direction < 8; direction++) {
+		offsets[direction] = (directions[direction][0] * stride) + directions[direction][1];
+	}
+}
+
+/*
+ * Carves every per-node array out of a single malloc. The block is over-
+ * allocated by one cache line so the first array can be aligned, and every
+ * array's size is rounded up to whole cache lines so the rest stay aligned.
+ */
+void NodeGrid::allocate(bool own_occupancy) {
+	size_t occupancy_words = own_occupancy ? ((size_t) num_nodes + 63) / 64 : 0;
+	size_t bytes = cache_align(sizeof(int) * num_nodes) * 2 + cache_align(sizeof(float) * num_nodes) * 2 +
+		cache_align(sizeof(unsigned int) * num_nodes) + cache_align(sizeof(uint64_t) * occupancy_words);
+	block = malloc(bytes + CACHE_LINE);
+	if (block == NULL) {
+		fprintf(stderr, "Problem allocating memory for the node grid.\n");
+		g = parents = NULL;
+		stamps = NULL;
+		rhs = heuristic = NULL;
+		occupancy = NULL;
+		return;
+	}
+
+	char* next = (char*) cache_align((size_t) block);
+	g = (int*) next;
+	next += cache_align(sizeof(int) * num_nodes);
+	parents = (int*) next;
+	next += cache_align(sizeof(int) * num_nodes);
+	rhs = (float*) next;
+	next += cache_align(sizeof(float) * num_nodes);
+	heuristic = (float*) next;
+	next += cache_align(sizeof(float) * num_nodes);
+	stamps = (unsigned int*) next;
+	next += cache_align(sizeof(unsigned int) * num_nodes);
+	if (own_occupancy) {
+		occupancy = (uint64_t*) next;
+		memset(occupancy, 0, sizeof(uint64_t) * occupancy_words);
+	}
+	this->owns_occupancy = own_occupancy;
+
+	// Generation 0 is never current, so every node starts out stale
+	memset(stamps, 0, sizeof(unsigned int) * num_nodes);
+	generation = 1;
+}
+
+// Given number of rows, cols, and occupancy map, initializes nodes per path finding algo.
+NodeGrid::NodeGrid(int rows, int cols, bool** occ_map) {
+	set_dimensions(rows, cols);
+	allocate(true);
+	if (block == NULL) {
+		return;
 	}
 
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) {
-			// storing x,y location
-			node_map[row][col].x = row;
-			node_map[row][col].y = col;
-
-			/*
-			 * Floating points support infinity and math involving infinity
-			 * acccording to IEEE 754.
-			 */
-			CNode::set_cost_and_occupancy(&node_map[row][col], max_cost, occ_map[row][col]);
-			node_map[row][col].heuristic = max_heuristic;
-			node_map[row][col].rhs = max_rhs;
+			if (occ_map[row][col]) {
+				set_occupancy(index(row, col), true);
+			}
 		}
 	}
 
-	node_map[start_x][start_y].cost = 0;
-
-	return node_map;
+	// The border is always occupied so neighbors never need bounds checks
+	for (int col = -1; col <= cols; col++) {
+		set_occupancy(index(-1, col), true);
+		set_occupancy(index(rows, col), true);
+	}
+	for (int row = 0; row < rows; row++) {
+		set_occupancy(index(row, -1), true);
+		set_occupancy(index(row, cols), true);
+	}
 }
 
-void NodeMap::free_node_map(node_t **node_map) {
-	free_2d_arr((void **) node_map);
-	node_map = NULL;
+/*
+ * Grid with its own search state that reads its occupancy from another grid
+ * instead of keeping a copy, so any number of searches can share one map.
+ * The map must outlive this grid, and its occupancy must not change while a
+ * search on this grid is running.
+ */
+NodeGrid::NodeGrid(const NodeGrid* map) {
+	set_dimensions(map->rows, map->cols);
+	allocate(false);
+	if (block != NULL) {
+		occupancy = map->occupancy;
+	}
 }
 
-// Checks whether node is out of bounds
-bool NodeMap::outOfBounds(node_t **node_map, int row, int col, int rows, int cols) {
-	if ((row < 0) || (col < 0) ||
-		(row >= rows) || (col >= cols)) {
-		return true;
+// Copy constructor (a copy always owns its occupancy, even if the original shares one)
+NodeGrid::NodeGrid(const NodeGrid& other) {
+	set_dimensions(other.rows, other.cols);
+	allocate(true);
+	if ((block != NULL) && (other.block != NULL)) {
+		memcpy(g, other.g, sizeof(int) * num_nodes);
+		memcpy(parents, other.parents, sizeof(int) * num_nodes);
+		memcpy(rhs, other.rhs, sizeof(float) * num_nodes);
+		memcpy(heuristic, other.heuristic, sizeof(float) * num_nodes);
+		memcpy(stamps, other.stamps, sizeof(unsigned int) * num_nodes);
+		memcpy(occupancy, other.occupancy, sizeof(uint64_t) * ((num_nodes + 63) / 64));
+		generation = other.generation;
 	}
-	return false;
 }
 
-// Returns vector of neighbors for a given node
-vector<node*> NodeMap::get_neighbors(node_t **node_map, int row, int col, int rows, int cols) {
-	vector<node*> neighbors;
-
-	// adding non-diag neighbors
-	if ((!outOfBounds(node_map, row - 1, col, rows, cols)) && (!CNode::get_occupancy(&node_map[row - 1][col]))) {
-		neighbors.push_back(&node_map[row - 1][col]);
+// Copy assignment
+NodeGrid& NodeGrid::operator=(const NodeGrid& other) {
+	if (this == &other) {
+		return *this;
 	}
-	if ((!outOfBounds(node_map, row, col - 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row][col - 1]))) {
-		neighbors.push_back(&node_map[row][col - 1]);
+
+	free(this->block);
+	set_dimensions(other.rows, other.cols);
+	allocate(true);
+	if ((block != NULL) && (other.block != NULL)) {
+		memcpy(g, other.g, sizeof(int) * num_nodes);
+		memcpy(parents, other.parents, sizeof(int) * num_nodes);
+		memcpy(rhs, other.rhs, sizeof(float) * num_nodes);
+		memcpy(heuristic, other.heuristic, sizeof(float) * num_nodes);
+		memcpy(stamps, other.stamps, sizeof(unsigned int) * num_nodes);
+		memcpy(occupancy, other.occupancy, sizeof(uint64_t) * ((num_nodes + 63) / 64));
+		generation = other.generation;
 	}
-	if ((!outOfBounds(node_map, row + 1, col, rows, cols)) && (!CNode::get_occupancy(&node_map[row + 1][col]))) {
-		neighbors.push_back(&node_map[row + 1][col]);
+	return *this;
+}
+
+// Destructor
+NodeGrid::~NodeGrid() {
+	free(this->block);
+	this->block = NULL;
+}
+
+/*
+ * Eagerly sets every node to unvisited (infinite cost, no parent) in the
+ * current generation, keeping the occupancies. Only needed by planners that
+ * read nodes without visiting them first. Floating points support infinity
+ * and math involving infinity acccording to IEEE 754.
+ */
+void NodeGrid::reset() {
+	for (int index = 0; index < num_nodes; index++) {
+		g[index] = max_cost;
+		parents[index] = -1;
+		rhs[index] = max_rhs;
+		heuristic[index] = max_heuristic;
+		stamps[index] = generation;
 	}
-	if ((!outOfBounds(node_map, row, col + 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row][col + 1]))) {
-		neighbors.push_back(&node_map[row][col + 1]);
+}
+
+/*
+ * Starts a new search in O(1) by making every node stale. When the counter
+ * wraps around, the stamps are cleared so an old stamp can't look current.
+ */
+void NodeGrid::begin_search() {
+	generation++;
+	if (generation == 0) {
+		memset(stamps, 0, sizeof(unsigned int) * num_nodes);
+		generation = 1;
 	}
+}
 
-	// adding diag neighbors
-	if ((!outOfBounds(node_map, row - 1, col - 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row - 1][col - 1]))) {
-		neighbors.push_back(&node_map[row - 1][col - 1]);
+// Returns whether any node from first to last (inclusive) is occupied, testing 64 nodes at a time
+bool NodeGrid::range_occupied(int first, int last) {
+	int first_word = first >> 6, last_word = last >> 6;
+	uint64_t first_mask = ~(uint64_t) 0 << (first & 63), last_mask = ~(uint64_t) 0 >> (63 - (last & 63));
+	if (first_word == last_word) {
+		return (occupancy[first_word] & first_mask & last_mask) != 0;
 	}
-	if ((!outOfBounds(node_map, row + 1, col - 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row + 1][col - 1]))) {
-		neighbors.push_back(&node_map[row + 1][col - 1]);
+	if (occupancy[first_word] & first_mask) {
+		return true;
+	}
+	for (int word = first_word + 1; word < last_word; word++) {
+		if (occupancy[word]) {
+			return true;
+		}
 	}
-	if ((!outOfBounds(node_map, row + 1, col + 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row + 1][col + 1]))) {
-		neighbors.push_back(&node_map[row + 1][col + 1]);
+	return (occupancy[last_word] & last_mask) != 0;
+}
+
+/*
+ * Returns whether the straight line between the centers of two nodes stays
+ * clear of the inside of every occupied cell. Passing exactly through the
+ * corner between two occupied cells is allowed, as it is for diagonal moves.
+ * gmtry2i::runs_clear finds the run of columns the line crosses in every row
+ * it spans (the same runs pthfnd::tile_sight tests), and since a row's nodes
+ * are contiguous in the bitset, each run is a single range_occupied test.
+ */
+bool NodeGrid::line_of_sight(int from, int to) {
+	gmtry2i::vector2i a(col_of(from), row_of(from)), b(col_of(to), row_of(to));
+	return gmtry2i::runs_clear(a, b, [this](long first_col, long last_col, long row) {
+		return range_occupied(index((int) row, (int) first_col), index((int) row, (int) last_col));
+	});
+}
+
+int NodeGrid::get_rows() {
+	return this->rows;
+}
+
+int NodeGrid::get_cols() {
+	return this->cols;
+}
+
+int NodeGrid::get_num_nodes() {
+	return this->num_nodes;
+}
+
+// Returns the number of bytes held by the grid (not counting a shared occupancy)
+size_t NodeGrid::get_memory_usage() {
+	size_t occupancy_words = owns_occupancy ? ((size_t) num_nodes + 63) / 64 : 0;
+	return sizeof(NodeGrid) + CACHE_LINE + cache_align(sizeof(int) * num_nodes) * 2 +
+		cache_align(sizeof(float) * num_nodes) * 2 + cache_align(sizeof(unsigned int) * num_nodes) +
+		cache_align(sizeof(uint64_t) * occupancy_words);
+}
+
+/*
+ * Generates a path, which is returned as a list of tuples from start to finish.
+ * To do this, it follows the parent indices back from the goal until reaching
+ * the start (the node with no parent), which is O(path length). Before
+ * returning, list is reverse so that it goes from the start --> finish rather
+ * than finish --> start. Ensure that path exists before calling this function.
+ */
+vector<tuple<int, int>> NodeGrid::trace_path(int goal_index) {
+	vector<tuple<int, int>> path;
+
+	for (int node = goal_index; parents[node] != -1; node = parents[node]) {
+		path.push_back(make_tuple(row_of(node), col_of(node)));
 	}
-	if ((!outOfBounds(node_map, row - 1, col + 1, rows, cols)) && (!CNode::get_occupancy(&node_map[row - 1][col + 1]))) {
-		neighbors.push_back(&node_map[row - 1][col + 1]);
+
+	reverse(path.begin(), path.end());
+	return path;
+}
+
+/*
+ * Returns the octile cost of a path that starts at (start_x, start_y) and,
+ * like the paths the planners return, doesn't list the start itself.
+ */
+int NodeGrid::get_path_cost(int start_x, int start_y, const vector<tuple<int, int>>& path) {
+	int cost = 0, x = start_x, y = start_y;
+	for (const tuple<int, int>& step : path) {
+		bool diagonal = (get<0>(step) != x) && (get<1>(step) != y);
+		cost += diagonal ? DIAGONAL_COST : STRAIGHT_COST;
+		x = get<0>(step);
+		y = get<1>(step);
 	}
+	return cost;
+}
 
-	return neighbors;
+// Returns the straight-line length (in cells) of a path of waypoints that, like get_path_cost, doesn't list the start
+float NodeGrid::get_path_length(int start_x, int start_y, const vector<tuple<int, int>>& path) {
+	float length = 0;
+	int x = start_x, y = start_y;
+	for (const tuple<int, int>& step : path) {
+		int d_x = get<0>(step) - x, d_y = get<1>(step) - y;
+		length += sqrtf((float) ((d_x * d_x) + (d_y * d_y)));
+		x = get<0>(step);
+		y = get<1>(step);
+	}
+	return length;
 }
 
-// Prints out the cost matrix given a double pointer of nodes
-void NodeMap::print_cost_matrix(node_t** nodes, int rows, int cols) {
+// Prints out the cost matrix
+void NodeGrid::print_cost_matrix() {
 	printf("\n\nCost Matrix:\n");
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) {
-			printf("%d, ", CNode::get_cost(&nodes[row][col]));
+			printf("%d, ", visited(index(row, col)) ? g[index(row, col)] : max_cost);
 		}
 		printf("\n");
 	}
 	printf("\n");
 }
 
-// Prints out the occupancy matrix given a double pointer of nodes
-void NodeMap::print_occupancy_matrix(node_t** nodes, int rows, int cols) {
+// Prints out the occupancy matrix
+void NodeGrid::print_occupancy_matrix() {
 	printf("\n\nOccupancy Matrix:\n");
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) {
-			printf("%d, ", CNode::get_occupancy(&nodes[row][col]));
+			printf("%d, ", get_occupancy(index(row, col)));
 		}
 		printf("\n");
 	}
 	printf("\n");
 }
 
-// Prints out the heuristic matrix given a double pointer of nodes
-void NodeMap::print_heuristic_matrix(node_t** nodes, int rows, int cols) {
+// Prints out the heuristic matrix
+void NodeGrid::print_heuristic_matrix() {
 	printf("\n\nHeuristic Matrix:\n");
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) {
-			printf("%d, ", CNode::get_heuristic(&nodes[row][col]));
+			printf("%.2f, ", visited(index(row, col)) ? heuristic[index(row, col)] : max_heuristic);
 		}
 		printf("\n");
 	}
 	printf("\n");
 }
 
-/*
- * Generates a path, which is returned as a list of tuples from start to finish.
- * To do this, it traverse backwards from goal by finding neighbor with lowest
- * cost and continue till cost = 0, in which case, it is the start node. Before
- * returning, list is reverse so that it goes from the start --> finish rather
- * than finish --> start. Ensure that path exists before calling this function.
- */
-vector<tuple<int, int>> NodeMap::trace_path(node_t **node_map, int goal_x, int goal_y, int rows, int cols) {
-	int x = goal_x, y = goal_y;
-	vector<tuple<int, int>> path;
-
-	while (CNode::get_cost(&node_map[x][y]) != 0) {
-		path.push_back(make_tuple(x, y));
-		vector<node*> neighbors = NodeMap::get_neighbors(node_map, x, y, rows, cols);
-		node_t* min = &node_map[x][y];
-		for (int index = 0; index < neighbors.size(); index++) {
-			if (CNode::get_cost(neighbors[index]) < CNode::get_cost(&node_map[x][y])) {
-				min = neighbors[index];
-			}
-		}
-		x = min->x;
-		y = min->y;
-	}
-
-	reverse(path.begin(), path.end());
-	return path;
-}
-
-// Given a path and assosiated node map, prints out visually the path.
-void NodeMap::print_generated_path(node_t** node_map, vector<tuple<int, int>> path, int rows, int cols) {
+// Given a path, prints out visually the path.
+void NodeGrid::print_generated_path(vector<tuple<int, int>> path) {
 	printf("Reminder:\n\"0\" --> unoccupied nodes\n\"1\" --> occupied nodes\n\"2\" --> generated path\n");
 	printf("Final Matrix:\n");
 	for (int row = 0; row < rows; row++) {
 		for (int col = 0; col < cols; col++) {
 			bool inPath = false;
 			for (tuple<int, int> node_in_path : path) {
-				if ((get<0>(node_in_path) == row) && (get<1>(node_in_path))) {
+				if ((get<0>(node_in_path) == row) && (get<1>(node_in_path) == col)) {
 					inPath = true;
 					break;
 				}
@@ -161,9 +332,9 @@ void NodeMap::print_generated_path(node_t** node_map, vector<tuple<int, int>> pa
 				printf("2, ");
 			}
 			else {
-				printf("%d, ", CNode::get_occupancy(&node_map[row][col]));
+				printf("%d, ", get_occupancy(index(row, col)));
 			}
 		}
 		printf("\n");
 	}
-}
\ No newline at end of file
+}
@@ -2,11 +2,22 @@
 #include "header.hh"
 
 
-// Swaps 2 positions
+// Swaps 2 positions and keeps the nodes' heap slots in sync
 inline void NodePriorityQueue::swap(int index1, int index2) {
-	node_t* tmp = nodes[index1];
+	int tmp = nodes[index1];
 	nodes[index1] = nodes[index2];
 	nodes[index2] = tmp;
+	slots[nodes[index1]] = index1;
+	slots[nodes[index2]] = index2;
+
+	pq_key_t tmp_key = keys[index1];
+	keys[index1] = keys[index2];
+	keys[index2] = tmp_key;
+}
+
+// Lexicographically compares 2 keys
+bool NodePriorityQueue::keyLess(pq_key_t key1, pq_key_t key2) {
+	return (key1.k1 < key2.k1) || ((key1.k1 == key2.k1) && (key1.k2 < key2.k2));
 }
 
 // Gets next size for expanding pq
@@ -15,14 +26,6 @@ inline int NodePriorityQueue::getNextSize() {
 	return this->size;
 }
 
-// Gets next size for shrinking pq
-inline int NodePriorityQueue::getPrevSize() {
-	if (this->size > 10) {
-		this->size /= 2;
-	}
-	return this->size;
-}
-
 // Returns the parent of current entry
 inline int NodePriorityQueue::getParentIndex(int index) {
 	if (index == 0) return -1;
@@ -49,17 +52,15 @@ inline int NodePriorityQueue::getRightChildIndex(int index) {
 
 // Returns the larger element
 int NodePriorityQueue::getLargerElement(int index1, int index2) {
-	if ((this->nodes[index1]->heuristic + (float) CNode::get_cost(this->nodes[index1])) >
-		(this->nodes[index2]->heuristic + (float) CNode::get_cost(this->nodes[index2]))) {
+	if (keyLess(this->keys[index2], this->keys[index1])) {
 		return index1;
 	}
 	return index2;
 }
 
-// Returns the larger element
+// Returns the smaller element
 int NodePriorityQueue::getSmallerElement(int index1, int index2) {
-	if ((this->nodes[index1]->heuristic + (float) CNode::get_cost(this->nodes[index1])) <
-		(this->nodes[index2]->heuristic + (float) CNode::get_cost(this->nodes[index2]))) {
+	if (keyLess(this->keys[index1], this->keys[index2])) {
 		return index1;
 	}
 	return index2;
@@ -145,99 +146,252 @@ void NodePriorityQueue::heapify_helper(int index) {
 	}
 }
 
+// Moves an entry whose cost changed in either direction to its right spot
+void NodePriorityQueue::sift(int index) {
+	int parentIndex = getParentIndex(index);
+	if ((parentIndex != -1) && (getSmallerElement(parentIndex, index) == index)) {
+		bubbleUp(index);
+	}
+	else {
+		bubbleDown(index);
+	}
+}
+
+/*
+ * Grows the slot lookup so that the given index can be queued. Only queues
+ * that weren't told how many indices to expect ever need this.
+ */
+void NodePriorityQueue::reserveIndex(int index) {
+	int newNumIndices = (numIndices > 10) ? numIndices : 10;
+	while (newNumIndices <= index) {
+		newNumIndices *= 2;
+	}
+
+	this->slots = (int*)realloc((void*)this->slots, sizeof(int) * newNumIndices);
+	for (int slot = numIndices; slot < newNumIndices; slot++) {
+		this->slots[slot] = -1;
+	}
+	this->numIndices = newNumIndices;
+}
+
 // Constructor if no initial elements
 NodePriorityQueue::NodePriorityQueue() {
 	this->size = 10;
 	this->insertIndex = 0;
-	this->nodes = (node_t**)malloc(sizeof(node_t*) * this->size);
+	this->numIndices = 0;
+	this->nodes = (int*)malloc(sizeof(int) * this->size);
+	this->keys = (pq_key_t*)malloc(sizeof(pq_key_t) * this->size);
+	this->slots = NULL;
+}
+
+/*
+ * Constructor for a queue over node indices 0 to num_indices - 1 (e.g. rows *
+ * cols for a planner over a node grid). Every index fits in the heap at once,
+ * so push and pop never call realloc.
+ */
+NodePriorityQueue::NodePriorityQueue(int num_indices) {
+	this->size = (num_indices > 10) ? num_indices : 10;
+	this->insertIndex = 0;
+	this->numIndices = 0;
+	this->nodes = (int*)malloc(sizeof(int) * this->size);
+	this->keys = (pq_key_t*)malloc(sizeof(pq_key_t) * this->size);
+	this->slots = NULL;
+	reserveIndex(num_indices - 1);
 }
 
 // Constructor is exisitng elements for faster runtime
-NodePriorityQueue::NodePriorityQueue(int arr_size, node_t** ptrs) {
+NodePriorityQueue::NodePriorityQueue(int arr_size, int* indices, pq_key_t* initial_keys) {
 	this->size = 10;
 	this->insertIndex = arr_size;
+	this->numIndices = 0;
+	this->slots = NULL;
 	while (this->size < arr_size) {
 		getNextSize();
 	}
 
-	// Allocating space and moving ptrs to pq
-	this->nodes = (node_t**)malloc(sizeof(node_t*) * size);
+	// Allocating space and moving indices to pq
+	this->nodes = (int*)malloc(sizeof(int) * size);
+	this->keys = (pq_key_t*)malloc(sizeof(pq_key_t) * size);
 	for (int index = 0; index < arr_size; index++) {
-		this->nodes[index] = ptrs[index];
+		if (indices[index] >= numIndices) {
+			reserveIndex(indices[index]);
+		}
+		this->nodes[index] = indices[index];
+		this->slots[indices[index]] = index;
+		this->keys[index] = initial_keys[index];
 	}
 
 	// Converting initial entries into heap
 	heapify();
 }
 
+// Copy constructor
+NodePriorityQueue::NodePriorityQueue(const NodePriorityQueue& other) {
+	this->size = other.size;
+	this->insertIndex = other.insertIndex;
+	this->numIndices = other.numIndices;
+	this->nodes = (int*)malloc(sizeof(int) * this->size);
+	this->keys = (pq_key_t*)malloc(sizeof(pq_key_t) * this->size);
+	this->slots = (int*)malloc(sizeof(int) * this->numIndices);
+	memcpy(this->nodes, other.nodes, sizeof(int) * this->insertIndex);
+	memcpy(this->keys, other.keys, sizeof(pq_key_t) * this->insertIndex);
+	memcpy(this->slots, other.slots, sizeof(int) * this->numIndices);
+}
+
+// Copy assignment
+NodePriorityQueue& NodePriorityQueue::operator=(const NodePriorityQueue& other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	free(this->nodes);
+	free(this->keys);
+	free(this->slots);
+	this->size = other.size;
+	this->insertIndex = other.insertIndex;
+	this->numIndices = other.numIndices;
+	this->nodes = (int*)malloc(sizeof(int) * this->size);
+	this->keys = (pq_key_t*)malloc(sizeof(pq_key_t) * this->size);
+	this->slots = (int*)malloc(sizeof(int) * this->numIndices);
+	memcpy(this->nodes, other.nodes, sizeof(int) * this->insertIndex);
+	memcpy(this->keys, other.keys, sizeof(pq_key_t) * this->insertIndex);
+	memcpy(this->slots, other.slots, sizeof(int) * this->numIndices);
+	return *this;
+}
+
+// Destructor
+NodePriorityQueue::~NodePriorityQueue() {
+	free(this->nodes);
+	free(this->keys);
+	free(this->slots);
+	this->nodes = NULL;
+	this->keys = NULL;
+	this->slots = NULL;
+}
+
 // Returns whether the pq is empty
 bool NodePriorityQueue::isEmpty() {
 	return (this->insertIndex == 0);
 }
 
-// Adds a new element to the pq
-void NodePriorityQueue::push(node_t* newNode) {
+// Adds a new element to the pq (if it's already queued, its position is updated instead)
+void NodePriorityQueue::push(int newNode, pq_key_t key) {
+	if (contains(newNode)) {
+		update_key(newNode, key);
+		return;
+	}
+	if (newNode >= numIndices) {
+		reserveIndex(newNode);
+	}
+
 	// Expanding the array is necessary
 	if (insertIndex == size) {
-		this->nodes = (node_t **) realloc((void *) this->nodes,  sizeof(node_t *)  * getNextSize());
+		this->nodes = (int*) realloc((void *) this->nodes,  sizeof(int)  * getNextSize());
+		this->keys = (pq_key_t*) realloc((void*) this->keys, sizeof(pq_key_t) * this->size);
 	}
 
 	// Inserting into the pq
 	nodes[insertIndex] = newNode;
+	keys[insertIndex] = key;
+	slots[newNode] = insertIndex;
 
 	// Placing element into correct element in the pq
 	bubbleUp(insertIndex);
 	insertIndex++;
 }
 
-// Removes the min element from the heap
-node_t* NodePriorityQueue::pop() {
+// Removes the min element from the heap, returns -1 if the pq is empty
+int NodePriorityQueue::pop() {
 	// Edge case
 	if (isEmpty()) {
-		return NULL;
+		return -1;
 	}
 
 	// Swapping root with end element
 	swap(0, --insertIndex);
 
 	// Storing the min element
-	node_t* min_node = this->nodes[insertIndex];
+	int min_node = this->nodes[insertIndex];
+	slots[min_node] = -1;
 
 	// Placing swapped element in right spot
 	bubbleDown(0);
 
-	// Shrinking the array if necessary
-	int prevSize = getPrevSize();
-	if ((prevSize != 10) && ((double)insertIndex / (double)this->size) < .5) {
-		this->nodes = (node_t**)realloc((void*)this->nodes, sizeof(node_t*) * prevSize);
+	return min_node;
+}
+
+// Returns the min element without removing it, or -1 if the pq is empty
+int NodePriorityQueue::top() {
+	if (isEmpty()) {
+		return -1;
 	}
+	return this->nodes[0];
+}
 
-	return min_node;
+// Returns the key of the min element, or an infinite key if the pq is empty
+pq_key_t NodePriorityQueue::top_key() {
+	if (isEmpty()) {
+		return { max_rhs, max_rhs };
+	}
+	return this->keys[0];
 }
 
-int NodePriorityQueue::find(node_t* to_find) {
-	for (int index = 0; index < insertIndex; index++) {
-		if (nodes[index] == to_find) {
-			return index;
-		}
+// Returns the heap slot of the given node, or -1 if it isn't queued
+int NodePriorityQueue::find(int to_find) {
+	if ((to_find < 0) || (to_find >= numIndices)) {
+		return -1;
 	}
-	
-	return -1;
+	return slots[to_find];
+}
+
+// Returns whether the given node is queued
+bool NodePriorityQueue::contains(int to_find) {
+	return (find(to_find) != -1);
 }
 
-void NodePriorityQueue::update_node_cost(node_t *to_update, int cost) {
-	// Updating cost
-	CNode::set_cost(to_update, cost);
+// Removes the given node from the pq, returns false if it wasn't queued
+bool NodePriorityQueue::remove(int to_remove) {
+	int index = find(to_remove);
+	if (index == -1) {
+		return false;
+	}
+
+	// Moving the last element into the freed slot
+	swap(index, --insertIndex);
+	slots[to_remove] = -1;
+	if (index < insertIndex) {
+		sift(index);
+	}
+
+	return true;
+}
 
+// Replaces the key of a queued node and moves it to its new spot in the pq
+void NodePriorityQueue::update_key(int to_update, pq_key_t key) {
 	int index = find(to_update);
 	if (index == -1) {
-		// Element not found
 		return;
 	}
 
-	// Updating location in pq
-	bubbleUp(index);
-	bubbleDown(index);
+	keys[index] = key;
+	sift(index);
+}
+
+// Lowers the key of a queued node, which can only move it towards the root
+void NodePriorityQueue::decrease_key(int to_update, pq_key_t key) {
+	int index = find(to_update);
+	if (index != -1) {
+		keys[index] = key;
+		bubbleUp(index);
+	}
+}
+
+// Removes every element from the pq, keeping the allocated space
+void NodePriorityQueue::clear() {
+	for (int index = 0; index < insertIndex; index++) {
+		slots[nodes[index]] = -1;
+	}
+	insertIndex = 0;
 }
 
 int NodePriorityQueue::get_size() {
@@ -246,11 +400,9 @@ int NodePriorityQueue::get_size() {
 
 
 void NodePriorityQueue::print_heap() {
-	printf("Heap (index: cost + heuristic): ");
+	printf("Heap (index: node, key): ");
 	for (int index = 0; index < insertIndex; index++) {
-		//  + CNode::get_heuristic(nodes[index])
-		//printf("%d: %d, ", index, CNode::get_cost(nodes[index]));
-		printf("%d -> %p, ", index, nodes[index]);
+		printf("%d -> %d (%.2f), ", index, nodes[index], keys[index].k1);
 	}
 	printf("\n");
-}
\ No newline at end of file
+}
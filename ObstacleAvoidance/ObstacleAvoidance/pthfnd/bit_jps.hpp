@@ -0,0 +1,342 @@
+#pragma once
+
+#include "../ocpncy/occupancy.hpp"
+#include "../maps2/tilemaps2.hpp"
+
+#include <stdint.h>
+#include <bit>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+/*
+* Path finding directly on binary occupancy tiles.
+* Cells are addressed in world-space (same as the maps they are read from); moves are 8-connected and each one is a
+*	unit step, straight or diagonal. This differs from the NodeGrid planners, which charge octile costs.
+*/
+namespace pthfnd {
+	// Word of 64 occupancy states along a row or column of a bit_grid
+	typedef std::uint64_t bit_word;
+	const unsigned int LOG2_WORD_BITS = 6;
+	const unsigned int WORD_BITS = 1 << LOG2_WORD_BITS;
+	const bit_word ALL_OCCUPIED = ~static_cast<bit_word>(0);
+
+	/*
+	* Transposes an 8x8 mini so that bit (x, y) moves to bit (y, x)
+	* Afterwards, byte n of the result holds column n of the original mini
+	*/
+	inline ocpncy::omini transpose_mini(ocpncy::omini m) {
+		ocpncy::omini t;
+		t = (m ^ (m >> 7)) & 0x00AA00AA00AA00AAULL;
+		m = m ^ t ^ (t << 7);
+		t = (m ^ (m >> 14)) & 0x0000CCCC0000CCCCULL;
+		m = m ^ t ^ (t << 14);
+		t = (m ^ (m >> 28)) & 0x00000000F0F0F0F0ULL;
+		m = m ^ t ^ (t << 28);
+		return m;
+	}
+
+	/*
+	* Rectangular block of binary occupancies stored twice: as rows of bit_words (bit n of a row = cell x + n)
+	*	and as the transposed columns of bit_words (bit n of a column = cell y + n).
+	* Keeping both means a run along a row or a column can be scanned 64 cells at a time.
+	* Rows/columns one past each edge are stored as fully occupied, as is everything outside the bounds.
+	*/
+	class bit_grid {
+		gmtry2i::aligned_box2i bounds;
+		unsigned int width, height, row_words, col_words;
+		std::vector<bit_word> rows, cols;
+
+		inline bit_word* row_ptr(long y) {
+			return &rows[(y + 1) * row_words];
+		}
+		inline bit_word* col_ptr(long x) {
+			return &cols[(x + 1) * col_words];
+		}
+		// Copies one tile's minis into the rows and columns (tile must be aligned to 8 cells relative to bounds)
+		template <unsigned int log2_w>
+		void write_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			const unsigned int tile_w_minis = ocpncy::get_tile_width_minis(log2_w);
+			gmtry2i::vector2i local_origin = tile_origin - bounds.min;
+			for (unsigned int my = 0; my < tile_w_minis; my++) for (unsigned int mx = 0; mx < tile_w_minis; mx++) {
+				ocpncy::omini m = tile.minis[mx | (my << (log2_w - ocpncy::LOG2_MINIW))];
+				ocpncy::omini mt = transpose_mini(m);
+				long mini_x = local_origin.x + (mx << ocpncy::LOG2_MINIW);
+				long mini_y = local_origin.y + (my << ocpncy::LOG2_MINIW);
+				for (unsigned int i = 0; i < ocpncy::MINI_WIDTH; i++) {
+					long y = mini_y + i, x = mini_x + i;
+					if (y >= 0 && y < height && mini_x >= 0 && mini_x < width) row_ptr(y)[mini_x >> LOG2_WORD_BITS] |=
+						((m >> (i << ocpncy::LOG2_MINIW)) & 0xFF) << (mini_x & (WORD_BITS - 1));
+					if (x >= 0 && x < width && mini_y >= 0 && mini_y < height) col_ptr(x)[mini_y >> LOG2_WORD_BITS] |=
+						((mt >> (i << ocpncy::LOG2_MINIW)) & 0xFF) << (mini_y & (WORD_BITS - 1));
+				}
+			}
+		}
+		// Sets every bit outside of the bounds to occupied
+		void fill_border() {
+			for (unsigned int i = 0; i < row_words; i++) rows[i] = rows[(height + 1) * row_words + i] = ALL_OCCUPIED;
+			for (unsigned int i = 0; i < col_words; i++) cols[i] = cols[(width + 1) * col_words + i] = ALL_OCCUPIED;
+			if (width & (WORD_BITS - 1)) for (unsigned int y = 0; y < height; y++)
+				row_ptr(y)[row_words - 1] |= ALL_OCCUPIED << (width & (WORD_BITS - 1));
+			if (height & (WORD_BITS - 1)) for (unsigned int x = 0; x < width; x++)
+				col_ptr(x)[col_words - 1] |= ALL_OCCUPIED << (height & (WORD_BITS - 1));
+		}
+	public:
+		bit_grid(const gmtry2i::aligned_box2i& grid_bounds) {
+			bounds = grid_bounds;
+			width = bounds.max.x - bounds.min.x;
+			height = bounds.max.y - bounds.min.y;
+			row_words = (width + WORD_BITS - 1) >> LOG2_WORD_BITS;
+			col_words = (height + WORD_BITS - 1) >> LOG2_WORD_BITS;
+			rows = std::vector<bit_word>((height + 2) * row_words, 0);
+			cols = std::vector<bit_word>((width + 2) * col_words, 0);
+			fill_border();
+		}
+		/*
+		* Reads every tile of the map that lies in the bounds
+		* Bounds should be tile-aligned with the map; space with no tile is treated as unoccupied
+		*/
+		template <unsigned int log2_w>
+		bit_grid(maps2::map_istream<ocpncy::otile<log2_w>>* map, const gmtry2i::aligned_box2i& grid_bounds) :
+			bit_grid(grid_bounds) {
+			const long tile_w = 1 << log2_w;
+			for (long y = bounds.min.y; y < bounds.max.y; y += tile_w) for (long x = bounds.min.x; x < bounds.max.x; x += tile_w) {
+				const ocpncy::otile<log2_w>* tile = map->read(gmtry2i::vector2i(x, y));
+				if (tile) write_tile(gmtry2i::vector2i(x, y), *tile);
+			}
+			fill_border();
+		}
+		gmtry2i::aligned_box2i get_bounds() const {
+			return bounds;
+		}
+		// Returns whether the world-space cell is occupied (anything outside the bounds is occupied)
+		inline bool get_occ(const gmtry2i::vector2i& p) const {
+			gmtry2i::vector2i local_p = p - bounds.min;
+			if (local_p.x < 0 || local_p.y < 0 || local_p.x >= width || local_p.y >= height) return true;
+			return (rows[(local_p.y + 1) * row_words + (local_p.x >> LOG2_WORD_BITS)] >>
+			        (local_p.x & (WORD_BITS - 1))) & 1;
+		}
+		// Sets the world-space cell's occupancy in both the rows and the columns
+		void set_occ(const gmtry2i::vector2i& p, bool value) {
+			gmtry2i::vector2i local_p = p - bounds.min;
+			if (local_p.x < 0 || local_p.y < 0 || local_p.x >= width || local_p.y >= height) return;
+			bit_word row_bit = static_cast<bit_word>(1) << (local_p.x & (WORD_BITS - 1));
+			bit_word col_bit = static_cast<bit_word>(1) << (local_p.y & (WORD_BITS - 1));
+			bit_word& row_word = row_ptr(local_p.y)[local_p.x >> LOG2_WORD_BITS];
+			bit_word& col_word = col_ptr(local_p.x)[local_p.y >> LOG2_WORD_BITS];
+			row_word = value ? (row_word | row_bit) : (row_word & ~row_bit);
+			col_word = value ? (col_word | col_bit) : (col_word & ~col_bit);
+		}
+		// Overwrites the cells covered by a tile (tile origin must be 8-cell aligned with the bounds)
+		template <unsigned int log2_w>
+		void update_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			const long tile_w = 1 << log2_w;
+			for (long y = tile_origin.y; y < tile_origin.y + tile_w; y++)
+				for (long x = tile_origin.x; x < tile_origin.x + tile_w; x++) set_occ(gmtry2i::vector2i(x, y), false);
+			write_tile(tile_origin, tile);
+		}
+		/*
+		* Scans a row (horizontal = true) or a column from local position pos along the lane in direction dir (+1/-1)
+		* Returns the first position that is a jump point: either the target position or a free cell with a forced
+		*	neighbor (side cell occupied while the next cell past it along the lane is free).
+		* Returns -1 if the lane is blocked before any jump point, or the scan leaves the grid.
+		* 64 cells are tested per word using count-trailing/leading-zero instructions.
+		*/
+		long scan(bool horizontal, long lane, long pos, int dir, long target) const {
+			const bit_word* lane_words = horizontal ? &rows[(lane + 1) * row_words] : &cols[(lane + 1) * col_words];
+			const bit_word* side_a = horizontal ? &rows[(lane + 2) * row_words] : &cols[(lane + 2) * col_words];
+			const bit_word* side_b = horizontal ? &rows[lane * row_words] : &cols[lane * col_words];
+			const long num_words = horizontal ? row_words : col_words;
+			auto word = [num_words](const bit_word* words, long i) {
+				return (i < 0 || i >= num_words) ? ALL_OCCUPIED : words[i];
+			};
+			long i = (pos + dir) >> LOG2_WORD_BITS;
+			if (pos + dir < 0) return -1;
+			while (i >= 0 && i < num_words) {
+				bit_word blocked = lane_words[i], a = side_a[i], b = side_b[i], forced;
+				if (dir > 0) {
+					// Bit n of a "next" word is the state one cell further along the lane
+					bit_word next_a = (a >> 1) | (word(side_a, i + 1) << (WORD_BITS - 1));
+					bit_word next_b = (b >> 1) | (word(side_b, i + 1) << (WORD_BITS - 1));
+					forced = (a & ~next_a) | (b & ~next_b);
+				}
+				else {
+					bit_word prev_a = (a << 1) | (word(side_a, i - 1) >> (WORD_BITS - 1));
+					bit_word prev_b = (b << 1) | (word(side_b, i - 1) >> (WORD_BITS - 1));
+					forced = (a & ~prev_a) | (b & ~prev_b);
+				}
+				bit_word stops = blocked | forced;
+				if (target >= 0 && (target >> LOG2_WORD_BITS) == i)
+					stops |= static_cast<bit_word>(1) << (target & (WORD_BITS - 1));
+				// Ignore the starting cell and everything behind it
+				long first_bit = i << LOG2_WORD_BITS;
+				if (dir > 0 && pos >= first_bit) stops &= ALL_OCCUPIED << (pos - first_bit) << 1;
+				if (dir < 0 && pos < first_bit + WORD_BITS) stops &= ~(ALL_OCCUPIED << (pos - first_bit));
+				if (stops) {
+					long stop_bit = dir > 0 ? std::countr_zero(stops) : (WORD_BITS - 1 - std::countl_zero(stops));
+					if ((blocked >> stop_bit) & 1) return -1;
+					return first_bit + stop_bit;
+				}
+				i += dir;
+			}
+			return -1;
+		}
+		inline long get_width() const {
+			return width;
+		}
+		inline long get_height() const {
+			return height;
+		}
+	};
+
+	/*
+	* Jump point search over a bit_grid
+	* Straight jumps are scanned a word at a time along the rows or the transposed columns;
+	*	diagonal jumps step one cell at a time, running a straight scan in both component directions at every step.
+	*/
+	class bit_jps {
+		const bit_grid& grid;
+		long width, height;
+		gmtry2i::vector2i goal;
+		std::vector<unsigned int> g;
+		std::vector<long> parents;
+		unsigned int expansions;
+
+		struct open_entry {
+			unsigned int f, g;
+			long idx;
+			bool operator <(const open_entry& other) const {
+				return f > other.f || (f == other.f && g < other.g);
+			}
+		};
+		std::priority_queue<open_entry> open;
+
+		// All positions below are local to the grid
+		inline bool is_free(long x, long y) const {
+			return !grid.get_occ(gmtry2i::vector2i(x, y) + grid.get_bounds().min);
+		}
+		inline unsigned int get_heuristic(long x, long y) const {
+			return std::max(std::abs(goal.x - x), std::abs(goal.y - y));
+		}
+		// Returns whether a straight scan from (x, y) finds a jump point
+		inline bool straight_jump(long x, long y, int dx, int dy, long* jump_x, long* jump_y) const {
+			if (dx) {
+				long stop = grid.scan(true, y, x, dx, goal.y == y ? goal.x : -1);
+				if (stop < 0) return false;
+				*jump_x = stop; *jump_y = y;
+			}
+			else {
+				long stop = grid.scan(false, x, y, dy, goal.x == x ? goal.y : -1);
+				if (stop < 0) return false;
+				*jump_x = x; *jump_y = stop;
+			}
+			return true;
+		}
+		bool jump(long x, long y, int dx, int dy, long* jump_x, long* jump_y) const {
+			if (!dx || !dy) return straight_jump(x, y, dx, dy, jump_x, jump_y);
+			long tmp_x, tmp_y;
+			while (true) {
+				x += dx; y += dy;
+				if (!is_free(x, y)) return false;
+				if ((x == goal.x && y == goal.y) ||
+				    (!is_free(x - dx, y) && is_free(x - dx, y + dy)) ||
+				    (!is_free(x, y - dy) && is_free(x + dx, y - dy)) ||
+				    straight_jump(x, y, dx, 0, &tmp_x, &tmp_y) || straight_jump(x, y, 0, dy, &tmp_x, &tmp_y)) {
+					*jump_x = x; *jump_y = y;
+					return true;
+				}
+			}
+		}
+		void add_successor(long x, long y, int dx, int dy) {
+			long jump_x, jump_y;
+			if (!jump(x, y, dx, dy, &jump_x, &jump_y)) return;
+			unsigned int new_g = g[x + y * width] + std::max(std::abs(jump_x - x), std::abs(jump_y - y));
+			long jump_idx = jump_x + jump_y * width;
+			if (new_g < g[jump_idx]) {
+				g[jump_idx] = new_g;
+				parents[jump_idx] = x + y * width;
+				open.push({ new_g + get_heuristic(jump_x, jump_y), new_g, jump_idx });
+			}
+		}
+	public:
+		bit_jps(const bit_grid& search_grid) : grid(search_grid) {
+			width = grid.get_width();
+			height = grid.get_height();
+			expansions = 0;
+		}
+		/*
+		* Returns each world-space cell of a shortest path from start to finish (excluding the start),
+		*	or an empty path if the goal can't be reached
+		*/
+		std::vector<gmtry2i::vector2i> generate_path(const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish) {
+			std::vector<gmtry2i::vector2i> path;
+			gmtry2i::vector2i origin = grid.get_bounds().min;
+			gmtry2i::vector2i local_start = start - origin;
+			goal = finish - origin;
+			if (grid.get_occ(start) || grid.get_occ(finish)) return path;
+
+			g.assign(width * height, -1);
+			parents.assign(width * height, -1);
+			open = std::priority_queue<open_entry>();
+			expansions = 0;
+
+			long start_idx = local_start.x + local_start.y * width;
+			long goal_idx = goal.x + goal.y * width;
+			g[start_idx] = 0;
+			open.push({ get_heuristic(local_start.x, local_start.y), 0, start_idx });
+			while (!open.empty()) {
+				open_entry top = open.top();
+				open.pop();
+				// Skip entries that were superseded by a cheaper push
+				if (top.g != g[top.idx]) continue;
+				expansions++;
+				if (top.idx == goal_idx) break;
+
+				long x = top.idx % width, y = top.idx / width;
+				long parent = parents[top.idx];
+				if (parent < 0) {
+					for (int dx = -1; dx <= 1; dx++) for (int dy = -1; dy <= 1; dy++)
+						if (dx || dy) add_successor(x, y, dx, dy);
+					continue;
+				}
+				long parent_x = parent % width, parent_y = parent / width;
+				int dx = (x > parent_x) - (x < parent_x);
+				int dy = (y > parent_y) - (y < parent_y);
+				if (dx && dy) {
+					add_successor(x, y, dx, 0);
+					add_successor(x, y, 0, dy);
+					add_successor(x, y, dx, dy);
+					if (!is_free(x - dx, y)) add_successor(x, y, -dx, dy);
+					if (!is_free(x, y - dy)) add_successor(x, y, dx, -dy);
+				}
+				else if (dx) {
+					add_successor(x, y, dx, 0);
+					if (!is_free(x, y + 1)) add_successor(x, y, dx, 1);
+					if (!is_free(x, y - 1)) add_successor(x, y, dx, -1);
+				}
+				else {
+					add_successor(x, y, 0, dy);
+					if (!is_free(x + 1, y)) add_successor(x, y, 1, dy);
+					if (!is_free(x - 1, y)) add_successor(x, y, -1, dy);
+				}
+			}
+			if (g[goal_idx] == static_cast<unsigned int>(-1)) return path;
+
+			// Walk back through the jump points, filling in the cells between them
+			for (long idx = goal_idx; parents[idx] >= 0; idx = parents[idx]) {
+				long x = idx % width, y = idx / width;
+				long parent_x = parents[idx] % width, parent_y = parents[idx] / width;
+				int dx = (parent_x > x) - (parent_x < x);
+				int dy = (parent_y > y) - (parent_y < y);
+				for (; x != parent_x || y != parent_y; x += dx, y += dy)
+					path.push_back(gmtry2i::vector2i(x, y) + origin);
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+		// Returns the number of jump points expanded by the last search
+		unsigned int get_expansions() const {
+			return expansions;
+		}
+	};
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+#include "wavefront.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+
+/*
+* Hierarchical path finding (HPA*) over the tiles of an occupancy map.
+* Every tile is a cluster. Entrances are placed where cells on both sides of a border between two clusters are free,
+*	and the entrances of a cluster are joined by the step counts between them without leaving the cluster.
+* A query plans over that abstract graph and then only refines the clusters along its route, so paths are close to,
+*	but not always, the shortest. Costs within a cluster come from its wavefronts, so every 8-connected move
+*	counts as one step, diagonals included.
+*/
+namespace pthfnd {
+	// Straight runs of free border cells at least this long get an entrance at both ends instead of one in the middle
+	const unsigned int HPA_LONG_ENTRANCE = 6;
+
+	// Crossing from an entrance to a cell (indexed by compress_coords2) of the neighboring cluster nbrs[nbr]
+	struct hpa_link {
+		unsigned int nbr, cell;
+		bool operator ==(const hpa_link& other) const {
+			return nbr == other.nbr && cell == other.cell;
+		}
+	};
+
+	// Cell (indexed by compress_coords2) of a cluster that the abstract graph passes through
+	struct hpa_entrance {
+		unsigned int cell;
+		std::vector<hpa_link> links;
+		bool operator ==(const hpa_entrance& other) const {
+			return cell == other.cell && links == other.links;
+		}
+	};
+
+	/*
+	* Cluster of the abstract graph, with its entrances sorted by cell
+	* costs[i * n + j] is the number of steps from entrance i to entrance j without leaving the cluster
+	*	(UNREACHED if there's no such path), and is only up to date if the cluster isn't stale
+	*/
+	template <unsigned int log2_w>
+	struct hpa_cluster {
+		gmtry2i::vector2i origin;
+		unsigned int id;
+		ocpncy::otile<log2_w> free;
+		std::vector<hpa_entrance> entrances;
+		std::vector<unsigned int> costs;
+		bool stale;
+	};
+
+	/*
+	* Abstract graph of a region of a tile map, planned over with A*
+	* Clusters are linked tiles, so entrances cross over to their neighbors through neighbor links. Only tiles inside
+	*	the region are clusters and anything outside of it is occupied; space in the region that has no tile is
+	*	unoccupied. A cluster's costs are computed the first time a query passes through it, and are only computed
+	*	again once its cells or its entrances change.
+	*/
+	template <unsigned int log2_w>
+	class hpa_star {
+		typedef maps2::nbrng_tile<hpa_cluster<log2_w>> linked_cluster;
+		static constexpr unsigned int TILE_W = 1 << log2_w;
+		static constexpr unsigned int TILE_AREA = 1 << (2 * log2_w);
+
+		// Node of the abstract graph reached by a query
+		struct abstract_node {
+			unsigned int g;
+			uint64_t parent;
+			linked_cluster* cluster;
+			unsigned int cell;
+		};
+		struct open_entry {
+			unsigned int f, g;
+			uint64_t key;
+			bool operator <(const open_entry& other) const {
+				return f > other.f || (f == other.f && g < other.g);
+			}
+		};
+
+		gmtry2i::aligned_box2i bounds;
+		maps2::nbrng_tile_linker<log2_w, hpa_cluster<log2_w>> linker;
+		std::vector<linked_cluster*> clusters;
+		unsigned int expansions;
+		// Step counts of one wavefront, kept between calls so costs and refinement don't need a tile's worth of stack
+		std::vector<unsigned int> wave_steps;
+
+		static inline unsigned int cell_of(unsigned int x, unsigned int y) {
+			return x | (y << log2_w);
+		}
+		static inline bool is_free(const hpa_cluster<log2_w>& c, unsigned int cell) {
+			return ocpncy::get_occ(cell & (TILE_W - 1), cell >> log2_w, c.free);
+		}
+		static inline gmtry2i::vector2i world_of(const linked_cluster* lc, unsigned int cell) {
+			return lc->tile.origin + gmtry2i::vector2i(cell & (TILE_W - 1), cell >> log2_w);
+		}
+		// Returns the key of a cell of a cluster in the abstract graph
+		static inline uint64_t key_of(const linked_cluster* lc, unsigned int cell) {
+			return (static_cast<uint64_t>(lc->tile.id) << (2 * log2_w)) | cell;
+		}
+		// Fills in the step count from a cell to every other cell of its cluster, without leaving the cluster
+		static void cell_wavefront(const hpa_cluster<log2_w>& c, unsigned int cell, unsigned int* steps) {
+			ocpncy::otile<log2_w> source = ocpncy::otile<log2_w>();
+			ocpncy::put_occ(cell & (TILE_W - 1), cell >> log2_w, source);
+			tile_wavefront<log2_w>(c.free, source, steps);
+		}
+		// Returns the index of the entrance at a cell, or -1 if there isn't one
+		static int find_entrance(const hpa_cluster<log2_w>& c, unsigned int cell) {
+			auto it = std::lower_bound(c.entrances.begin(), c.entrances.end(), cell,
+				[](const hpa_entrance& e, unsigned int cell) { return e.cell < cell; });
+			return (it != c.entrances.end() && it->cell == cell) ? static_cast<int>(it - c.entrances.begin()) : -1;
+		}
+		/*
+		* Finds every crossing out of a cluster and groups them by cell into its entrances
+		* Crossings only depend on the cells on both sides of a border, so two neighbors always agree on them
+		* If the entrances changed, the cluster's costs become stale; returns whether they changed
+		*/
+		bool find_entrances(linked_cluster* lc) {
+			const unsigned int last = TILE_W - 1;
+			const hpa_cluster<log2_w>& c = lc->tile;
+			std::vector<std::pair<unsigned int, hpa_link>> crossings;
+			auto cross = [&crossings](unsigned int cell, unsigned int nbr, unsigned int nbr_cell) {
+				crossings.push_back({ cell, { nbr, nbr_cell } });
+			};
+
+			// Borders shared with the neighbors below (1), to the left (3), to the right (4) and above (6)
+			for (unsigned int nbr : { 1, 3, 4, 6 }) {
+				if (!lc->nbrs[nbr]) continue;
+				const hpa_cluster<log2_w>& n = lc->nbrs[nbr]->tile;
+				bool vertical = (nbr == 3 || nbr == 4);
+				unsigned int own_edge = (nbr == 1 || nbr == 3) ? 0 : last;
+				// Returns the cell at position i along the border, on this cluster's side or on the neighbor's
+				auto border_cell = [=](unsigned int i, bool own) {
+					unsigned int edge = own ? own_edge : last - own_edge;
+					return vertical ? cell_of(edge, i) : cell_of(i, edge);
+				};
+				auto border_free = [&](unsigned int i, bool own) {
+					return is_free(own ? c : n, border_cell(i, own));
+				};
+				bool straight[TILE_W];
+				for (unsigned int i = 0; i < TILE_W; i++) straight[i] = border_free(i, true) && border_free(i, false);
+
+				// Each straight run gets an entrance in its middle, or one at each end if it's long
+				for (unsigned int i = 0; i < TILE_W; ) {
+					if (!straight[i]) {
+						i++;
+						continue;
+					}
+					unsigned int run_end = i;
+					while (run_end < TILE_W && straight[run_end]) run_end++;
+					if (run_end - i < HPA_LONG_ENTRANCE) {
+						unsigned int middle = i + (run_end - i) / 2;
+						cross(border_cell(middle, true), nbr, border_cell(middle, false));
+					}
+					else {
+						cross(border_cell(i, true), nbr, border_cell(i, false));
+						cross(border_cell(run_end - 1, true), nbr, border_cell(run_end - 1, false));
+					}
+					i = run_end;
+				}
+				// A diagonal crossing is only needed if there's no straight crossing on either side of it
+				for (unsigned int i = 0; i + 1 < TILE_W; i++) {
+					if (straight[i] || straight[i + 1]) continue;
+					if (border_free(i, true) && border_free(i + 1, false))
+						cross(border_cell(i, true), nbr, border_cell(i + 1, false));
+					if (border_free(i + 1, true) && border_free(i, false))
+						cross(border_cell(i + 1, true), nbr, border_cell(i, false));
+				}
+			}
+			// Corners shared with the diagonal neighbors
+			for (unsigned int nbr : { 0, 2, 5, 7 }) {
+				if (!lc->nbrs[nbr]) continue;
+				unsigned int x = (nbr == 2 || nbr == 7) ? last : 0, y = (nbr >= 5) ? last : 0;
+				if (is_free(c, cell_of(x, y)) && is_free(lc->nbrs[nbr]->tile, cell_of(last - x, last - y)))
+					cross(cell_of(x, y), nbr, cell_of(last - x, last - y));
+			}
+
+			std::sort(crossings.begin(), crossings.end(), [](const auto& a, const auto& b) {
+				if (a.first != b.first) return a.first < b.first;
+				return a.second.nbr < b.second.nbr || (a.second.nbr == b.second.nbr && a.second.cell < b.second.cell);
+			});
+			std::vector<hpa_entrance> entrances;
+			for (const auto& crossing : crossings) {
+				if (entrances.empty() || entrances.back().cell != crossing.first) entrances.push_back({ crossing.first, {} });
+				entrances.back().links.push_back(crossing.second);
+			}
+			if (entrances == c.entrances) return false;
+			lc->tile.entrances = std::move(entrances);
+			lc->tile.stale = true;
+			return true;
+		}
+		// Returns a cluster's entrance-to-entrance step counts, computing them first if they're stale
+		const std::vector<unsigned int>& get_costs(linked_cluster* lc) {
+			hpa_cluster<log2_w>& c = lc->tile;
+			if (c.stale) {
+				size_t n = c.entrances.size();
+				c.costs.assign(n * n, UNREACHED);
+				for (size_t i = 0; i < n; i++) {
+					cell_wavefront(c, c.entrances[i].cell, wave_steps.data());
+					for (size_t j = 0; j < n; j++) c.costs[i * n + j] = wave_steps[c.entrances[j].cell];
+				}
+				c.stale = false;
+			}
+			return c.costs;
+		}
+		// Adds the cells of a shortest path inside a cluster from one cell (excluded) to another (included)
+		void refine(const linked_cluster* lc, unsigned int from, unsigned int to, std::vector<gmtry2i::vector2i>& path) {
+			cell_wavefront(lc->tile, to, wave_steps.data());
+			long x = from & (TILE_W - 1), y = from >> log2_w;
+			for (unsigned int remaining = wave_steps[from]; remaining > 0; remaining--) {
+				bool stepped = false;
+				for (int dx = -1; dx <= 1 && !stepped; dx++) for (int dy = -1; dy <= 1 && !stepped; dy++) {
+					long next_x = x + dx, next_y = y + dy;
+					if (next_x < 0 || next_y < 0 || next_x > TILE_W - 1 || next_y > TILE_W - 1) continue;
+					if (wave_steps[cell_of(next_x, next_y)] != remaining - 1) continue;
+					x = next_x;
+					y = next_y;
+					stepped = true;
+				}
+				path.push_back(lc->tile.origin + gmtry2i::vector2i(x, y));
+			}
+		}
+		// Returns the cluster containing the world-space point, or 0 if it's outside the region
+		inline linked_cluster* get_cluster(const gmtry2i::vector2i& p) {
+			if (!gmtry2i::contains(bounds, p)) return 0;
+			return linker.get(p);
+		}
+		inline unsigned int get_heuristic(const gmtry2i::vector2i& p, const gmtry2i::vector2i& finish) const {
+			return std::max(std::abs(finish.x - p.x), std::abs(finish.y - p.y));
+		}
+	public:
+		/*
+		* Reads every tile of the map that lies in the bounds and finds every cluster's entrances
+		* Bounds are expanded out to the map's tile borders
+		*/
+		hpa_star(maps2::map_istream<ocpncy::otile<log2_w>>* map, const gmtry2i::aligned_box2i& graph_bounds) :
+			bounds(maps2::align_out(graph_bounds, map->get_bounds().min, log2_w)), linker(bounds.min), wave_steps(TILE_AREA) {
+			hpa_cluster<log2_w> c = hpa_cluster<log2_w>();
+			c.stale = true;
+			for (long y = bounds.min.y; y < bounds.max.y; y += TILE_W) for (long x = bounds.min.x; x < bounds.max.x; x += TILE_W) {
+				c.origin = gmtry2i::vector2i(x, y);
+				c.id = clusters.size();
+				const ocpncy::otile<log2_w>* tile = map->read(c.origin);
+				for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++)
+					c.free.minis[i] = tile ? ~tile->minis[i] : ~static_cast<ocpncy::omini>(0);
+				linker.write(c.origin, &c);
+				clusters.push_back(linker.get(c.origin));
+			}
+			for (linked_cluster* lc : clusters) find_entrances(lc);
+			expansions = 0;
+		}
+		gmtry2i::aligned_box2i get_bounds() const {
+			return bounds;
+		}
+		/*
+		* Overwrites the occupancy of the tile at the given origin
+		* Its entrances and its neighbors' are found again, and only the clusters whose cells or entrances changed
+		*	have their costs recomputed
+		*/
+		void update_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			linked_cluster* lc = get_cluster(tile_origin);
+			if (!lc) return;
+			ocpncy::otile<log2_w> free;
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++) free.minis[i] = ~tile.minis[i];
+			if (!ocpncy::is_occupied(free ^ lc->tile.free)) return;
+			lc->tile.free = free;
+			lc->tile.stale = true;
+			find_entrances(lc);
+			for (linked_cluster* nbr : lc->nbrs) if (nbr) find_entrances(nbr);
+		}
+		/*
+		* Returns each world-space cell of a path from start to finish (excluding the start),
+		*	or an empty path if the goal can't be reached
+		* The start and goal are joined to the entrances of their clusters for the length of the query
+		*/
+		std::vector<gmtry2i::vector2i> generate_path(const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish) {
+			std::vector<gmtry2i::vector2i> path;
+			expansions = 0;
+			linked_cluster* start_cluster = get_cluster(start);
+			linked_cluster* goal_cluster = get_cluster(finish);
+			if (!start_cluster || !goal_cluster || (start.x == finish.x && start.y == finish.y)) return path;
+			gmtry2i::vector2i local_start = start - start_cluster->tile.origin, local_goal = finish - goal_cluster->tile.origin;
+			unsigned int start_cell = cell_of(local_start.x, local_start.y), goal_cell = cell_of(local_goal.x, local_goal.y);
+			if (!is_free(start_cluster->tile, start_cell) || !is_free(goal_cluster->tile, goal_cell)) return path;
+
+			std::vector<unsigned int> start_steps(TILE_AREA), goal_steps(TILE_AREA);
+			cell_wavefront(start_cluster->tile, start_cell, start_steps.data());
+			cell_wavefront(goal_cluster->tile, goal_cell, goal_steps.data());
+
+			uint64_t start_key = key_of(start_cluster, start_cell), goal_key = key_of(goal_cluster, goal_cell);
+			std::unordered_map<uint64_t, abstract_node> nodes;
+			std::priority_queue<open_entry> open;
+			auto relax = [&](linked_cluster* lc, unsigned int cell, unsigned int g, uint64_t parent) {
+				uint64_t key = key_of(lc, cell);
+				abstract_node& node = nodes.try_emplace(key, abstract_node{ UNREACHED, 0, lc, cell }).first->second;
+				if (g < node.g) {
+					node.g = g;
+					node.parent = parent;
+					open.push({ g + get_heuristic(world_of(lc, cell), finish), g, key });
+				}
+			};
+			relax(start_cluster, start_cell, 0, start_key);
+			while (!open.empty()) {
+				open_entry top = open.top();
+				open.pop();
+				abstract_node node = nodes.at(top.key);
+				// Skip entries that were superseded by a cheaper push
+				if (top.g != node.g) continue;
+				expansions++;
+				if (top.key == goal_key) break;
+
+				linked_cluster* lc = node.cluster;
+				const hpa_cluster<log2_w>& c = lc->tile;
+				if (lc == goal_cluster && goal_steps[node.cell] != UNREACHED)
+					relax(lc, goal_cell, node.g + goal_steps[node.cell], top.key);
+				int entrance = find_entrance(c, node.cell);
+				// The start is the only node that may not be an entrance
+				if (entrance < 0) {
+					for (const hpa_entrance& e : c.entrances) if (start_steps[e.cell] != UNREACHED)
+						relax(lc, e.cell, node.g + start_steps[e.cell], top.key);
+					continue;
+				}
+				const std::vector<unsigned int>& costs = get_costs(lc);
+				size_t n = c.entrances.size();
+				for (size_t j = 0; j < n; j++) if (j != static_cast<size_t>(entrance) && costs[entrance * n + j] != UNREACHED)
+					relax(lc, c.entrances[j].cell, node.g + costs[entrance * n + j], top.key);
+				for (const hpa_link& link : c.entrances[entrance].links)
+					relax(lc->nbrs[link.nbr], link.cell, node.g + 1, top.key);
+			}
+			auto goal_node = nodes.find(goal_key);
+			if (goal_node == nodes.end() || goal_node->second.g == UNREACHED) return path;
+
+			// Refine the route, which alternates between moves inside a cluster and single steps across a border
+			std::vector<uint64_t> route;
+			for (uint64_t key = goal_key; key != start_key; key = nodes.at(key).parent) route.push_back(key);
+			route.push_back(start_key);
+			std::reverse(route.begin(), route.end());
+			for (size_t i = 1; i < route.size(); i++) {
+				const abstract_node& from = nodes.at(route[i - 1]);
+				const abstract_node& to = nodes.at(route[i]);
+				if (from.cluster != to.cluster) path.push_back(world_of(to.cluster, to.cell));
+				else refine(to.cluster, from.cell, to.cell, path);
+			}
+			return path;
+		}
+		// Returns the number of abstract nodes expanded by the last query
+		unsigned int get_expansions() const {
+			return expansions;
+		}
+		// Returns the number of entrances in the abstract graph
+		size_t get_num_entrances() const {
+			size_t num_entrances = 0;
+			for (const linked_cluster* lc : clusters) num_entrances += lc->tile.entrances.size();
+			return num_entrances;
+		}
+	};
+}
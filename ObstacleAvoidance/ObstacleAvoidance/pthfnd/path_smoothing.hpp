@@ -0,0 +1,194 @@
+#pragma once
+
+#include "../ocpncy/occupancy.hpp"
+#include "../maps2/tilemaps2.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+
+/*
+* Turning a path of cells into a short list of waypoints for the flight controller.
+* Paths are shortcut along straight lines that a line of sight query clears, then waypoints that barely bend the
+*	path are dropped. Like the planners' paths, paths here exclude the start and include the goal.
+*/
+namespace pthfnd {
+	/*
+	* Line of sight queries over the tiles of a map, which may be any map_istream
+	* A line crosses a contiguous run of cells in each row that it spans, and a run is tested one mini at a time
+	*	by masking the byte that holds the mini's row, so a run costs one word operation per 8 cells.
+	* Space in the map's bounds with no tile is unoccupied; space outside of them is occupied.
+	* The last tile read is kept, so call invalidate after writing to the map.
+	*/
+	template <unsigned int log2_w>
+	class tile_sight {
+		static constexpr long TILE_W = 1 << log2_w;
+		maps2::map_istream<ocpncy::otile<log2_w>>* map;
+		gmtry2i::vector2i tile_origin;
+		ocpncy::otile<log2_w> tile;
+		bool has_tile;
+		size_t minis_tested;
+
+		// Reads the tile at the given origin into the cache, where a missing tile is read as unoccupied
+		inline void load_tile(const gmtry2i::vector2i& origin) {
+			if (has_tile && origin.x == tile_origin.x && origin.y == tile_origin.y) return;
+			const ocpncy::otile<log2_w>* map_tile = map->read(origin);
+			tile = map_tile ? *map_tile : ocpncy::otile<log2_w>();
+			tile_origin = origin;
+			has_tile = true;
+		}
+		// Returns whether any cell from (first_x, y) to (last_x, y) is occupied
+		bool run_occupied(long first_x, long last_x, long y) {
+			gmtry2i::aligned_box2i bounds = map->get_bounds();
+			if (y < bounds.min.y || y >= bounds.max.y || first_x < bounds.min.x || last_x >= bounds.max.x) return true;
+			for (long x = first_x; x <= last_x;) {
+				load_tile(maps2::align_down(gmtry2i::vector2i(x, y), bounds.min, log2_w));
+				long local_x = x - tile_origin.x, local_y = y - tile_origin.y;
+				// Part of the run in this mini
+				long mini_last_x = std::min(last_x - tile_origin.x, local_x | static_cast<long>(ocpncy::MINI_COORD_MASK));
+				ocpncy::omini m = tile.minis[(local_x >> ocpncy::LOG2_MINIW) |
+				                             ((local_y >> ocpncy::LOG2_MINIW) << (log2_w - ocpncy::LOG2_MINIW))];
+				unsigned int row = (m >> ((local_y & ocpncy::MINI_COORD_MASK) << ocpncy::LOG2_MINIW)) & 0xFF;
+				unsigned int mask = (0xFFu << (local_x & ocpncy::MINI_COORD_MASK)) &
+				                    (0xFFu >> (ocpncy::MINI_COORD_MASK - (mini_last_x & ocpncy::MINI_COORD_MASK)));
+				minis_tested++;
+				if (row & mask) return true;
+				x = tile_origin.x + mini_last_x + 1;
+			}
+			return false;
+		}
+	public:
+		tile_sight(maps2::map_istream<ocpncy::otile<log2_w>>* sight_map) {
+			map = sight_map;
+			has_tile = false;
+			minis_tested = 0;
+		}
+		// Returns whether the straight line between the centers of two cells stays clear of every occupied cell
+		// The runs are the same ones NodeGrid::line_of_sight tests, found by gmtry2i::runs_clear
+		bool line_of_sight(const gmtry2i::vector2i& a, const gmtry2i::vector2i& b) {
+			return gmtry2i::runs_clear(a, b, [this](long first_x, long last_x, long y) {
+				return run_occupied(first_x, last_x, y);
+			});
+		}
+		bool operator ()(const gmtry2i::vector2i& a, const gmtry2i::vector2i& b) {
+			return line_of_sight(a, b);
+		}
+		// Forgets the cached tile, which must be done after the map changes
+		void invalidate() {
+			has_tile = false;
+		}
+		// Returns the number of mini rows tested so far
+		size_t get_minis_tested() const {
+			return minis_tested;
+		}
+	};
+
+	/*
+	* Greedily shortcuts a path: from each waypoint, the next one is the farthest point of the path found that
+	*	it can see. The search gallops ahead (1, 2, 4, ... points) until sight is lost and then bisects back,
+	*	so a leg of n points costs O(log n) queries. sight is any callable taking two cells.
+	* Every leg of the result is in sight, though a point past one that can't be seen is never considered.
+	*/
+	template <typename sight_t>
+	std::vector<gmtry2i::vector2i> shortcut_path(sight_t& sight, const gmtry2i::vector2i& start,
+	                                             const std::vector<gmtry2i::vector2i>& path) {
+		std::vector<gmtry2i::vector2i> waypoints;
+		gmtry2i::vector2i anchor = start;
+		size_t next = 0;
+		while (next < path.size()) {
+			// Farthest point known to be in sight (the next point is, being the path's next step) and nearest known not to be
+			size_t seen = next, unseen = path.size();
+			for (size_t step = 1; seen + step < path.size(); step *= 2) {
+				if (!sight(anchor, path[seen + step])) {
+					unseen = seen + step;
+					break;
+				}
+				seen += step;
+			}
+			while (unseen - seen > 1) {
+				size_t middle = seen + (unseen - seen) / 2;
+				if (sight(anchor, path[middle])) seen = middle;
+				else unseen = middle;
+			}
+			waypoints.push_back(path[seen]);
+			anchor = path[seen];
+			next = seen + 1;
+		}
+		return waypoints;
+	}
+
+	// Returns the distance from p to the segment from a to b
+	inline double segment_distance(const gmtry2i::vector2i& p, const gmtry2i::vector2i& a, const gmtry2i::vector2i& b) {
+		double abx = b.x - a.x, aby = b.y - a.y, apx = p.x - a.x, apy = p.y - a.y;
+		double length_sqrd = abx * abx + aby * aby;
+		double t = (length_sqrd > 0) ? std::clamp((apx * abx + apy * aby) / length_sqrd, 0.0, 1.0) : 0.0;
+		double dx = apx - t * abx, dy = apy - t * aby;
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	/*
+	* Drops the waypoints that bend the path by no more than tolerance cells (Douglas-Peucker): a stretch of the
+	*	path is replaced by a single leg if every waypoint in it lies within tolerance of that leg and the leg is
+	*	in sight; otherwise it's split at the waypoint farthest from the leg. A tolerance of 0 only merges legs that
+	*	are collinear. The result never cuts through an occupied cell, whatever the tolerance.
+	*/
+	template <typename sight_t>
+	std::vector<gmtry2i::vector2i> compress_path(sight_t& sight, const gmtry2i::vector2i& start,
+	                                             const std::vector<gmtry2i::vector2i>& path, double tolerance) {
+		std::vector<gmtry2i::vector2i> points;
+		points.reserve(path.size() + 1);
+		points.push_back(start);
+		points.insert(points.end(), path.begin(), path.end());
+		std::vector<bool> keep(points.size(), false);
+		keep.back() = true;
+		// Stretches (first and last point) that are left to simplify
+		std::vector<std::pair<size_t, size_t>> stretches;
+		if (points.size() > 2) stretches.push_back({ 0, points.size() - 1 });
+		while (!stretches.empty()) {
+			std::pair<size_t, size_t> stretch = stretches.back();
+			stretches.pop_back();
+			size_t farthest = stretch.first + 1;
+			double farthest_distance = -1;
+			for (size_t i = stretch.first + 1; i < stretch.second; i++) {
+				double distance = segment_distance(points[i], points[stretch.first], points[stretch.second]);
+				if (distance > farthest_distance) {
+					farthest = i;
+					farthest_distance = distance;
+				}
+			}
+			if (farthest_distance <= tolerance && sight(points[stretch.first], points[stretch.second])) continue;
+			keep[farthest] = true;
+			if (farthest - stretch.first > 1) stretches.push_back({ stretch.first, farthest });
+			if (stretch.second - farthest > 1) stretches.push_back({ farthest, stretch.second });
+		}
+		std::vector<gmtry2i::vector2i> waypoints;
+		for (size_t i = 1; i < points.size(); i++) if (keep[i]) waypoints.push_back(points[i]);
+		return waypoints;
+	}
+
+	// Shortcuts a path and then drops the waypoints that bend it by no more than tolerance cells
+	template <typename sight_t>
+	std::vector<gmtry2i::vector2i> smooth_path(sight_t& sight, const gmtry2i::vector2i& start,
+	                                           const std::vector<gmtry2i::vector2i>& path, double tolerance) {
+		return compress_path(sight, start, shortcut_path(sight, start, path), tolerance);
+	}
+
+	/*
+	* Smooths a path of (x, y) tuples, as the NodeGrid planners return them
+	* sight takes two gmtry2i::vector2i cells, so a NodeGrid can be queried with
+	*	[&](auto a, auto b) { return grid.line_of_sight(grid.index(a.x, a.y), grid.index(b.x, b.y)); }
+	*/
+	template <typename sight_t>
+	std::vector<std::tuple<int, int>> smooth_path(sight_t& sight, int start_x, int start_y,
+	                                              const std::vector<std::tuple<int, int>>& path, double tolerance) {
+		std::vector<gmtry2i::vector2i> cells;
+		cells.reserve(path.size());
+		for (const std::tuple<int, int>& cell : path) cells.push_back(gmtry2i::vector2i(std::get<0>(cell), std::get<1>(cell)));
+		std::vector<std::tuple<int, int>> waypoints;
+		for (const gmtry2i::vector2i& p : smooth_path(sight, gmtry2i::vector2i(start_x, start_y), cells, tolerance))
+			waypoints.push_back(std::make_tuple(static_cast<int>(p.x), static_cast<int>(p.y)));
+		return waypoints;
+	}
+}
@@ -0,0 +1,457 @@
+#pragma once
+
+#include "wavefront.hpp"
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+/*
+* A* over a state lattice, where a state is a cell and one of 16 headings, so paths come out drivable: a move is one
+*	of a few motion primitives (straight on, or a gentle turn to the next heading either way) and turning costs more
+*	than going straight. The primitives and the cells they sweep are worked out at compile time.
+* Occupancy is read from the minis of a tile map. Each primitive's swept cells are a mini-sized mask around its start
+*	cell, so an expansion gathers the map's 8x8 window around the state once and checks each primitive with one AND.
+*/
+namespace pthfnd {
+	const unsigned int LATTICE_HEADINGS = 16;
+	const unsigned int LATTICE_PRIMITIVES_PER_HEADING = 3;
+	const unsigned int LATTICE_NUM_PRIMITIVES = LATTICE_HEADINGS * LATTICE_PRIMITIVES_PER_HEADING;
+	// Cost of moving one cell, and the extra cost of a primitive that changes heading
+	const unsigned int LATTICE_STEP_COST = 10;
+	const unsigned int LATTICE_TURN_COST = 4;
+	// Farthest a primitive reaches from its start cell; a footprint's bit (x, y) is the cell (x - REACH, y - REACH) from it
+	const long LATTICE_REACH = 3;
+	// Primitive that reached a state that no primitive reached (the start of a search)
+	const unsigned char NO_PRIMITIVE = 0xFF;
+
+	/*
+	* Direction of each heading, as the cell that a straight primitive moves to. Headings go counterclockwise from +x
+	*	and turning 4 headings is a quarter turn, so every primitive rotated a quarter turn is another primitive.
+	*/
+	constexpr long LATTICE_DIRECTIONS[LATTICE_HEADINGS][2] = {
+		{ 1, 0 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 0, 1 }, { -1, 2 }, { -1, 1 }, { -2, 1 },
+		{ -1, 0 }, { -2, -1 }, { -1, -1 }, { -1, -2 }, { 0, -1 }, { 1, -2 }, { 1, -1 }, { 2, -1 }
+	};
+
+	/*
+	* Move from a state's cell to a cell up to LATTICE_REACH away, changing heading from start_heading to end_heading
+	* footprint holds every cell that the move's center line passes through, including both ends
+	*/
+	struct motion_primitive {
+		unsigned char start_heading, end_heading;
+		long dx, dy;
+		unsigned int cost;
+		ocpncy::omini footprint;
+	};
+
+	// Heading of a state in a lattice path, and the primitive that got there
+	struct lattice_state {
+		gmtry2i::vector2i p;
+		unsigned int heading;
+		unsigned int primitive;
+	};
+
+	// std::floor and std::sqrt aren't constexpr, so primitives are built with these
+	constexpr long lattice_floor(double x) {
+		long i = static_cast<long>(x);
+		return (x < i) ? i - 1 : i;
+	}
+	constexpr double lattice_sqrt(double x) {
+		if (x <= 0) return 0;
+		double root = (x > 1) ? x : 1;
+		for (int i = 0; i < 64; i++) {
+			double next = (root + x / root) / 2;
+			if (next >= root) break;
+			root = next;
+		}
+		return root;
+	}
+
+	/*
+	* Builds the primitive that starts facing heading and turns by turn (-1, 0 or 1) headings
+	* Its path is a quadratic Bezier curve between cell centers: straight on to the heading's direction, or, for
+	*	a turn, along the heading's direction and then the new heading's, so the curve leaves and arrives tangent
+	*	to its headings. The center line is sampled closely enough that each sample's box, which covers the curve
+	*	up to the next sample, is enough to find every cell it passes through.
+	*/
+	constexpr motion_primitive make_motion_primitive(unsigned int heading, int turn) {
+		unsigned int end_heading = (heading + LATTICE_HEADINGS + turn) % LATTICE_HEADINGS;
+		double p1x = LATTICE_DIRECTIONS[heading][0], p1y = LATTICE_DIRECTIONS[heading][1];
+		double p2x = p1x + LATTICE_DIRECTIONS[end_heading][0], p2y = p1y + LATTICE_DIRECTIONS[end_heading][1];
+		if (!turn) {
+			p2x = p1x;
+			p2y = p1y;
+			p1x /= 2;
+			p1y /= 2;
+		}
+		const int num_samples = 64;
+		double max_speed = 2 * std::max(lattice_sqrt(p1x * p1x + p1y * p1y),
+		                                lattice_sqrt((p2x - p1x) * (p2x - p1x) + (p2y - p1y) * (p2y - p1y)));
+		double margin = max_speed / (2 * num_samples) + 1e-6;
+		double length = 0, last_x = 0, last_y = 0;
+		ocpncy::omini footprint = 0;
+		for (int i = 0; i <= num_samples; i++) {
+			double t = static_cast<double>(i) / num_samples;
+			double x = 2 * (1 - t) * t * p1x + t * t * p2x, y = 2 * (1 - t) * t * p1y + t * t * p2y;
+			length += lattice_sqrt((x - last_x) * (x - last_x) + (y - last_y) * (y - last_y));
+			last_x = x;
+			last_y = y;
+			// Cell centers are at whole coordinates, so a cell spans half a cell either way of its center
+			for (long cy = lattice_floor(y + 0.5 - margin); cy <= lattice_floor(y + 0.5 + margin); cy++)
+				for (long cx = lattice_floor(x + 0.5 - margin); cx <= lattice_floor(x + 0.5 + margin); cx++)
+					footprint |= static_cast<ocpncy::omini>(1) << ((cx + LATTICE_REACH) | ((cy + LATTICE_REACH) << ocpncy::LOG2_MINIW));
+		}
+		motion_primitive primitive = {};
+		primitive.start_heading = static_cast<unsigned char>(heading);
+		primitive.end_heading = static_cast<unsigned char>(end_heading);
+		primitive.dx = static_cast<long>(p2x);
+		primitive.dy = static_cast<long>(p2y);
+		primitive.cost = static_cast<unsigned int>(lattice_floor(LATTICE_STEP_COST * length + 0.5)) + (turn ? LATTICE_TURN_COST : 0);
+		primitive.footprint = footprint;
+		return primitive;
+	}
+	// Primitives of heading h are at 3 h (turning clockwise), 3 h + 1 (straight on) and 3 h + 2 (turning counterclockwise)
+	constexpr std::array<motion_primitive, LATTICE_NUM_PRIMITIVES> make_motion_primitives() {
+		std::array<motion_primitive, LATTICE_NUM_PRIMITIVES> primitives = {};
+		for (unsigned int h = 0; h < LATTICE_HEADINGS; h++) for (int turn = -1; turn <= 1; turn++)
+			primitives[h * LATTICE_PRIMITIVES_PER_HEADING + (turn + 1)] = make_motion_primitive(h, turn);
+		return primitives;
+	}
+	constexpr std::array<motion_primitive, LATTICE_NUM_PRIMITIVES> LATTICE_PRIMITIVES = make_motion_primitives();
+
+	/*
+	* Returns the cheapest cost of moving by (dx, dy) in straight runs along the headings' directions, ignoring turns
+	* The directions are symmetric about the axes and diagonals, so the displacement is folded to 0 <= dy <= dx,
+	*	where it lies between (1, 0) and (2, 1) or between (2, 1) and (1, 1) and is a whole number of runs along each.
+	*	This cost is a norm, which makes it a consistent heuristic as long as no primitive costs less than its own
+	*	displacement does.
+	*/
+	constexpr unsigned int get_lattice_distance(long dx, long dy) {
+		long x = (dx < 0) ? -dx : dx, y = (dy < 0) ? -dy : dy;
+		if (y > x) std::swap(x, y);
+		const unsigned int axis = LATTICE_PRIMITIVES[1].cost, knight = LATTICE_PRIMITIVES[4].cost, diagonal = LATTICE_PRIMITIVES[7].cost;
+		if (2 * y <= x) return static_cast<unsigned int>((x - 2 * y) * axis + y * knight);
+		return static_cast<unsigned int>((x - y) * knight + (2 * y - x) * diagonal);
+	}
+	constexpr bool lattice_distance_is_consistent() {
+		for (const motion_primitive& p : LATTICE_PRIMITIVES) if (p.cost < get_lattice_distance(p.dx, p.dy)) return false;
+		return true;
+	}
+	static_assert(lattice_distance_is_consistent(), "Lattice distance must never overestimate a primitive's cost");
+	static_assert(LATTICE_PRIMITIVES[1].cost == LATTICE_STEP_COST && LATTICE_PRIMITIVES[1].footprint == 0x18000000ULL,
+	              "Straight primitive along +x should cost one step and sweep its two cells");
+
+	/*
+	* Monotone bucket queue (Dial's algorithm) over small integer costs, like the NodeGrid planners' BucketQueue, but
+	*	holding its entries by value so it needs nothing per state. There's a bucket for every cost up to the highest
+	*	pushed, and buckets keep their memory between searches. A cost below the lowest queued one is fine (the
+	*	lattice heuristic isn't quite consistent), it just moves the lowest back. Ties pop in LIFO order.
+	*/
+	template <typename entry_t>
+	class lattice_buckets {
+		std::vector<std::vector<entry_t>> buckets;
+		size_t lowest, size;
+	public:
+		lattice_buckets() {
+			lowest = size = 0;
+		}
+		bool empty() const {
+			return !size;
+		}
+		void push(unsigned int cost, const entry_t& entry) {
+			if (cost >= buckets.size()) buckets.resize(cost + 1);
+			buckets[cost].push_back(entry);
+			lowest = std::min(lowest, static_cast<size_t>(cost));
+			size++;
+		}
+		// Removes an entry with the lowest cost, which there must be
+		entry_t pop() {
+			while (buckets[lowest].empty()) lowest++;
+			entry_t entry = buckets[lowest].back();
+			buckets[lowest].pop_back();
+			size--;
+			return entry;
+		}
+		void clear() {
+			for (std::vector<entry_t>& bucket : buckets) bucket.clear();
+			lowest = buckets.size();
+			size = 0;
+		}
+	};
+
+	// Offsets within this many cells of the goal (either way) have their costs looked up
+	const long LATTICE_TABLE_RADIUS = 32;
+	// The table's searches reach this much farther out so that few of the paths they cut off would have been shorter
+	const long LATTICE_TABLE_MARGIN = 16;
+	const long LATTICE_TABLE_WIDTH = 2 * LATTICE_TABLE_RADIUS + 1;
+
+	/*
+	* Builds the heuristic table: for each of the first 4 headings, the cheapest cost of a path on an empty map from
+	*	the origin to each offset within LATTICE_TABLE_RADIUS, arriving with any heading. The other headings are
+	*	quarter turns of these, and heading 3 is heading 1 mirrored about the diagonal. Costs come from Dijkstra's
+	*	algorithm over the primitives in a square reaching LATTICE_TABLE_MARGIN past the table. A path that leaves
+	*	that square has to go out at least RADIUS + MARGIN cells along an axis and come back at least MARGIN, which
+	*	costs at least that many straight steps along the axis, so capping each entry at that cost keeps every entry
+	*	admissible.
+	*/
+	inline std::vector<unsigned int> make_lattice_heuristic_table() {
+		const long reach = LATTICE_TABLE_RADIUS + LATTICE_TABLE_MARGIN, width = 2 * reach + 1;
+		const unsigned int cap = get_lattice_distance(LATTICE_TABLE_RADIUS + 2 * LATTICE_TABLE_MARGIN, 0);
+		std::vector<unsigned int> table(4 * LATTICE_TABLE_WIDTH * LATTICE_TABLE_WIDTH, cap);
+		std::vector<unsigned int> costs(width * width * LATTICE_HEADINGS);
+		typedef std::pair<unsigned int, size_t> queued_state;
+		lattice_buckets<queued_state> open;
+		for (unsigned int start_heading = 0; start_heading < 3; start_heading++) {
+			std::fill(costs.begin(), costs.end(), UNREACHED);
+			open.clear();
+			size_t start = (reach * width + reach) * LATTICE_HEADINGS + start_heading;
+			costs[start] = 0;
+			open.push(0, { 0, start });
+			while (!open.empty()) {
+				queued_state top = open.pop();
+				if (top.first != costs[top.second]) continue;
+				long x = static_cast<long>((top.second / LATTICE_HEADINGS) % width), y = static_cast<long>((top.second / LATTICE_HEADINGS) / width);
+				unsigned int heading = top.second % LATTICE_HEADINGS;
+				long table_x = x - LATTICE_TABLE_MARGIN, table_y = y - LATTICE_TABLE_MARGIN;
+				if (table_x >= 0 && table_y >= 0 && table_x < LATTICE_TABLE_WIDTH && table_y < LATTICE_TABLE_WIDTH) {
+					unsigned int& entry = table[(start_heading * LATTICE_TABLE_WIDTH + table_y) * LATTICE_TABLE_WIDTH + table_x];
+					entry = std::min(entry, top.first);
+				}
+				for (unsigned int i = 0; i < LATTICE_PRIMITIVES_PER_HEADING; i++) {
+					const motion_primitive& p = LATTICE_PRIMITIVES[heading * LATTICE_PRIMITIVES_PER_HEADING + i];
+					long next_x = x + p.dx, next_y = y + p.dy;
+					if (next_x < 0 || next_y < 0 || next_x >= width || next_y >= width) continue;
+					size_t next = (next_y * width + next_x) * LATTICE_HEADINGS + p.end_heading;
+					if (top.first + p.cost >= costs[next]) continue;
+					costs[next] = top.first + p.cost;
+					open.push(costs[next], { costs[next], next });
+				}
+			}
+		}
+		for (long y = 0; y < LATTICE_TABLE_WIDTH; y++) for (long x = 0; x < LATTICE_TABLE_WIDTH; x++)
+			table[(3 * LATTICE_TABLE_WIDTH + y) * LATTICE_TABLE_WIDTH + x] = table[(LATTICE_TABLE_WIDTH + x) * LATTICE_TABLE_WIDTH + y];
+		return table;
+	}
+	// Returns the heuristic table, which is built the first time it's needed and shared by every planner
+	inline const std::vector<unsigned int>& get_lattice_heuristic_table() {
+		static const std::vector<unsigned int> table = make_lattice_heuristic_table();
+		return table;
+	}
+
+	/*
+	* Admissible estimate of the cost from a state to any state at the goal's cell
+	* Near the goal it's the cost on an empty map, read from the heuristic table; farther out it's the lattice
+	*	distance. Both only ever underestimate, though where they meet the estimate may not be consistent, so the
+	*	planner lets a state be expanded again if a cheaper path to it turns up.
+	*/
+	inline unsigned int get_lattice_heuristic(long dx, long dy, unsigned int heading) {
+		unsigned int h = get_lattice_distance(dx, dy);
+		// Turning the offset back by the heading's quarter turns makes it relative to one of the first 4 headings
+		for (unsigned int quarter = 0; quarter < heading / 4; quarter++) {
+			long x = dx;
+			dx = dy;
+			dy = -x;
+		}
+		if (std::abs(dx) > LATTICE_TABLE_RADIUS || std::abs(dy) > LATTICE_TABLE_RADIUS) return h;
+		const std::vector<unsigned int>& table = get_lattice_heuristic_table();
+		return std::max(h, table[((heading % 4) * LATTICE_TABLE_WIDTH + (dy + LATTICE_TABLE_RADIUS)) * LATTICE_TABLE_WIDTH +
+		                         (dx + LATTICE_TABLE_RADIUS)]);
+	}
+
+	/*
+	* State lattice planner over the tiles of a map, which may be any map_istream
+	* The occupancy in the bounds is copied into a grid of minis when the planner is made; keep it current with
+	*	update_tile. Space in the bounds with no tile is unoccupied and space outside of them is occupied.
+	* Like tile_a_star, search state is kept in one block per tile that's only allocated once a search reaches it,
+	*	and is reset lazily when a later search first touches it.
+	*/
+	template <unsigned int log2_w>
+	class state_lattice {
+		static constexpr long TILE_W = 1 << log2_w;
+		static constexpr unsigned int TILE_STATES = (1 << (2 * log2_w)) * LATTICE_HEADINGS;
+		static constexpr long TILE_W_MINIS = ocpncy::get_tile_width_minis(log2_w);
+
+		struct lattice_block {
+			unsigned int search_id;
+			unsigned int g[TILE_STATES];
+			unsigned char primitives[TILE_STATES];
+		};
+		struct open_entry {
+			unsigned int g;
+			// Cell from the bounds' corner
+			unsigned int x, y, heading;
+		};
+
+		gmtry2i::aligned_box2i bounds;
+		long width_tiles, width_minis, height_minis;
+		std::vector<ocpncy::omini> minis;
+		std::vector<std::unique_ptr<lattice_block>> blocks;
+		lattice_buckets<open_entry> open;
+		size_t num_blocks;
+		unsigned int search_id, expansions, cost;
+
+		// Returns the mini at the given mini coordinates from the bounds' corner, which is occupied outside of the bounds
+		inline ocpncy::omini get_mini(long mini_x, long mini_y) const {
+			if (mini_x < 0 || mini_y < 0 || mini_x >= width_minis || mini_y >= height_minis) return ~static_cast<ocpncy::omini>(0);
+			return minis[mini_y * width_minis + mini_x];
+		}
+		/*
+		* Returns the occupancy of the 8x8 cells whose corner is LATTICE_REACH cells below and left of (x, y), laid out
+		*	like a mini, so it lines up with the primitives' footprints. It's pieced together from the (up to) 4 minis
+		*	that it overlaps, shifting each into place and masking off the columns that wrap around.
+		*/
+		ocpncy::omini get_window(long x, long y) const {
+			long corner_x = x - LATTICE_REACH, corner_y = y - LATTICE_REACH;
+			long mini_x = corner_x >> ocpncy::LOG2_MINIW, mini_y = corner_y >> ocpncy::LOG2_MINIW;
+			unsigned int off_x = corner_x & ocpncy::MINI_COORD_MASK, off_y = corner_y & ocpncy::MINI_COORD_MASK;
+			// Columns that come from the minis on the left
+			ocpncy::omini left_cols = (0xFFULL >> off_x) * MINI_FIRST_COL;
+			ocpncy::omini window = (get_mini(mini_x, mini_y) >> (off_y << ocpncy::LOG2_MINIW) >> off_x) & left_cols;
+			if (off_x) window |= ((get_mini(mini_x + 1, mini_y) >> (off_y << ocpncy::LOG2_MINIW)) << (ocpncy::MINI_WIDTH - off_x)) & ~left_cols;
+			if (off_y) {
+				unsigned int up = (ocpncy::MINI_WIDTH - off_y) << ocpncy::LOG2_MINIW;
+				window |= ((get_mini(mini_x, mini_y + 1) << up) >> off_x) & left_cols;
+				if (off_x) window |= ((get_mini(mini_x + 1, mini_y + 1) << up) << (ocpncy::MINI_WIDTH - off_x)) & ~left_cols;
+			}
+			return window;
+		}
+		// Returns the block of the tile holding the cell (x, y) from the bounds' corner, allocating it if it's new
+		lattice_block& get_block(long x, long y) {
+			std::unique_ptr<lattice_block>& b = blocks[(y >> log2_w) * width_tiles + (x >> log2_w)];
+			if (!b) {
+				b.reset(new lattice_block());
+				num_blocks++;
+			}
+			if (b->search_id != search_id) {
+				std::fill(b->g, b->g + TILE_STATES, UNREACHED);
+				b->search_id = search_id;
+			}
+			return *b;
+		}
+		static inline unsigned int state_of(long x, long y, unsigned int heading) {
+			return static_cast<unsigned int>(((x & (TILE_W - 1)) | ((y & (TILE_W - 1)) << log2_w)) * LATTICE_HEADINGS + heading);
+		}
+	public:
+		// Plans over every tile of the map
+		state_lattice(maps2::map_istream<ocpncy::otile<log2_w>>* map) : state_lattice(map, map->get_bounds()) {}
+		// Only plans over the tiles of the map in the bounds, which are expanded out to the map's tile borders
+		state_lattice(maps2::map_istream<ocpncy::otile<log2_w>>* map, const gmtry2i::aligned_box2i& search_bounds) {
+			bounds = maps2::align_out(search_bounds, map->get_bounds().min, log2_w);
+			width_tiles = (bounds.max.x - bounds.min.x) >> log2_w;
+			width_minis = width_tiles * TILE_W_MINIS;
+			height_minis = ((bounds.max.y - bounds.min.y) >> log2_w) * TILE_W_MINIS;
+			minis.assign(width_minis * height_minis, 0);
+			blocks.resize(width_tiles * (height_minis / TILE_W_MINIS));
+			for (long y = bounds.min.y; y < bounds.max.y; y += TILE_W) for (long x = bounds.min.x; x < bounds.max.x; x += TILE_W) {
+				const ocpncy::otile<log2_w>* tile = map->read(gmtry2i::vector2i(x, y));
+				if (tile) update_tile(gmtry2i::vector2i(x, y), *tile);
+			}
+			num_blocks = 0;
+			search_id = 0;
+			expansions = 0;
+			cost = UNREACHED;
+			get_lattice_heuristic_table();
+		}
+		gmtry2i::aligned_box2i get_bounds() const {
+			return bounds;
+		}
+		/*
+		* Returns each state of a cheapest path from start, facing start_heading, to the finish cell facing any heading
+		*	(excluding the start), or an empty path if the finish can't be reached. Consecutive states are joined by the
+		*	primitive stored with the later one.
+		*/
+		std::vector<lattice_state> generate_path(const gmtry2i::vector2i& start, unsigned int start_heading,
+		                                         const gmtry2i::vector2i& finish) {
+			std::vector<lattice_state> path;
+			search_id++;
+			expansions = 0;
+			cost = UNREACHED;
+			open.clear();
+			start_heading %= LATTICE_HEADINGS;
+			if (!gmtry2i::contains(bounds, start) || !gmtry2i::contains(bounds, finish) || get_occ(start) || get_occ(finish)) return path;
+			gmtry2i::vector2i local_start = start - bounds.min, local_goal = finish - bounds.min;
+
+			get_block(local_start.x, local_start.y).g[state_of(local_start.x, local_start.y, start_heading)] = 0;
+			get_block(local_start.x, local_start.y).primitives[state_of(local_start.x, local_start.y, start_heading)] = NO_PRIMITIVE;
+			open.push(get_lattice_heuristic(local_goal.x - local_start.x, local_goal.y - local_start.y, start_heading),
+			          { 0, static_cast<unsigned int>(local_start.x), static_cast<unsigned int>(local_start.y), start_heading });
+			bool found = false;
+			open_entry top = {};
+			while (!open.empty()) {
+				top = open.pop();
+				// Skip entries that were superseded by a cheaper push
+				long x = top.x, y = top.y;
+				if (top.g != get_block(x, y).g[state_of(x, y, top.heading)]) continue;
+				expansions++;
+				if (x == local_goal.x && y == local_goal.y) {
+					found = true;
+					break;
+				}
+
+				ocpncy::omini window = get_window(x, y);
+				for (unsigned int i = 0; i < LATTICE_PRIMITIVES_PER_HEADING; i++) {
+					unsigned int primitive = top.heading * LATTICE_PRIMITIVES_PER_HEADING + i;
+					const motion_primitive& p = LATTICE_PRIMITIVES[primitive];
+					// Space outside of the bounds is occupied, so a primitive that's clear ends inside them
+					if (window & p.footprint) continue;
+					long next_x = x + p.dx, next_y = y + p.dy;
+					unsigned int new_g = top.g + p.cost, next_state = state_of(next_x, next_y, p.end_heading);
+					lattice_block& next_block = get_block(next_x, next_y);
+					if (new_g >= next_block.g[next_state]) continue;
+					next_block.g[next_state] = new_g;
+					next_block.primitives[next_state] = static_cast<unsigned char>(primitive);
+					open.push(new_g + get_lattice_heuristic(local_goal.x - next_x, local_goal.y - next_y, p.end_heading),
+					          { new_g, static_cast<unsigned int>(next_x), static_cast<unsigned int>(next_y), p.end_heading });
+				}
+			}
+			if (!found) return path;
+			cost = top.g;
+
+			// Walk back through the primitives, undoing each one
+			long x = top.x, y = top.y;
+			unsigned int heading = top.heading;
+			for (unsigned char primitive = get_block(x, y).primitives[state_of(x, y, heading)]; primitive != NO_PRIMITIVE;
+			     primitive = get_block(x, y).primitives[state_of(x, y, heading)]) {
+				const motion_primitive& p = LATTICE_PRIMITIVES[primitive];
+				path.push_back({ bounds.min + gmtry2i::vector2i(x, y), heading, primitive });
+				x -= p.dx;
+				y -= p.dy;
+				heading = p.start_heading;
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+		// Returns whether a world-space cell is occupied (cells outside of the bounds are)
+		bool get_occ(const gmtry2i::vector2i& p) const {
+			gmtry2i::vector2i local = p - bounds.min;
+			return (get_mini(local.x >> ocpncy::LOG2_MINIW, local.y >> ocpncy::LOG2_MINIW) >> ocpncy::get_bit_idx(local.x, local.y)) & 1;
+		}
+		// Overwrites the occupancy of the tile at the given origin
+		void update_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			if (!gmtry2i::contains(bounds, tile_origin)) return;
+			gmtry2i::vector2i local = tile_origin - bounds.min;
+			long first_mini = (local.y >> ocpncy::LOG2_MINIW) * width_minis + (local.x >> ocpncy::LOG2_MINIW);
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++)
+				minis[first_mini + (i / TILE_W_MINIS) * width_minis + (i % TILE_W_MINIS)] = tile.minis[i];
+		}
+		// Returns the cost of the last path found (UNREACHED if the last search found none)
+		unsigned int get_cost() const {
+			return cost;
+		}
+		// Returns the number of states expanded by the last search
+		unsigned int get_expansions() const {
+			return expansions;
+		}
+		// Returns the number of blocks allocated so far
+		size_t get_num_blocks() const {
+			return num_blocks;
+		}
+		// Returns the number of bytes taken by the copied occupancy and the blocks
+		size_t get_memory_usage() const {
+			return minis.size() * sizeof(ocpncy::omini) + num_blocks * sizeof(lattice_block);
+		}
+	};
+}
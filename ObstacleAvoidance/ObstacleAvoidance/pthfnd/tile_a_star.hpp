@@ -0,0 +1,339 @@
+#pragma once
+
+#include "wavefront.hpp"
+
+#include <stdint.h>
+#include <vector>
+#include <queue>
+#include <list>
+#include <memory>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <ios>
+#include <cstdio>
+
+// Move costs, defined the same as in header.hh so either header can be included first
+#ifndef STRAIGHT_COST
+#define STRAIGHT_COST (10)
+#endif
+#ifndef DIAGONAL_COST
+#define DIAGONAL_COST (14)
+#endif
+
+/*
+* A* that reads occupancy straight from the tiles of a map.
+* Search state lives in one block per tile, which is only allocated once the search reaches that tile, so memory
+*	scales with the explored area instead of the map's bounds. Moves are 8-connected and use the NodeGrid planners'
+*	octile costs, STRAIGHT_COST along an axis and DIAGONAL_COST on a diagonal.
+*/
+namespace pthfnd {
+	// Parent of a cell that no move reached (the start of a search)
+	const unsigned char NO_PARENT = 8;
+
+	/*
+	* Decoded tile and search state of one tile, indexed by compress_coords2
+	* parents holds the direction of the move that reached a cell, as an index into a nbrng_tile's nbrs
+	*/
+	template <unsigned int log2_w>
+	struct block_state {
+		ocpncy::otile<log2_w> free;
+		unsigned int g[1 << (2 * log2_w)];
+		unsigned char parents[1 << (2 * log2_w)];
+	};
+
+	/*
+	* Tile reached by a search, whose state is resident in one of the planner's slots, spilled to the planner's
+	*	spill file, or both (slot or spill is -1 where it isn't)
+	* The state's costs are only meaningful if search_id matches the current search; otherwise they're reset on first touch
+	*/
+	struct search_block {
+		gmtry2i::vector2i origin;
+		long slot, spill;
+		unsigned int search_id;
+	};
+
+	// Returns the displacement of a move in the direction of nbrs[dir]
+	inline gmtry2i::vector2i get_nbr_disp(unsigned int dir) {
+		unsigned int compressed_coords = dir + (dir > 3);
+		return gmtry2i::vector2i(static_cast<long>(compressed_coords % 3) - 1, static_cast<long>(compressed_coords / 3) - 1);
+	}
+
+	/*
+	* A* over a tile map, which may be any map_istream (a map_buffer or a map_fstream)
+	* Blocks are linked with their neighbors as they're allocated, so a move across a tile border follows a neighbor
+	*	link and only searches the tree the first time a tile is reached. Blocks are kept between searches until
+	*	clear is called, and are reset lazily when a search first touches them.
+	* Only tiles inside the bounds are searched; space in the bounds that has no tile is unoccupied.
+	* By default every block's state stays resident. With paging on, at most a fixed number of states are resident
+	*	and the least recently used one is spilled to a file to make room, so a search over a map too big to hold
+	*	in memory only keeps a small block (a few dozen bytes) per tile it has reached.
+	* Constructor and every search may throw an std::ios::failure if the spill file can't be used
+	*/
+	template <unsigned int log2_w>
+	class tile_a_star {
+		typedef maps2::nbrng_tile<search_block> linked_block;
+		static constexpr long TILE_W = 1 << log2_w;
+		// A block and all of its neighbors, so an expansion never pages out the block it's expanding
+		static constexpr size_t MIN_RESIDENT = 9;
+
+		struct open_entry {
+			unsigned int f, g;
+			linked_block* block;
+			unsigned int cell;
+			bool operator <(const open_entry& other) const {
+				return f > other.f || (f == other.f && g < other.g);
+			}
+		};
+		// Resident state of a block, with its place in the order that the slots were last used in
+		struct resident_slot {
+			block_state<log2_w> state;
+			linked_block* owner;
+			std::list<long>::iterator last_use;
+		};
+
+		maps2::map_istream<ocpncy::otile<log2_w>>* map;
+		gmtry2i::aligned_box2i bounds;
+		std::unique_ptr<maps2::nbrng_tile_linker<log2_w, search_block>> linker;
+		std::priority_queue<open_entry> open;
+		std::vector<std::unique_ptr<resident_slot>> slots;
+		// Slots, most recently used first
+		std::list<long> lru;
+		size_t max_resident;
+		std::fstream spill_file;
+		std::string spill_file_name;
+		long num_spilled;
+		size_t num_blocks, num_loads, num_spills;
+		unsigned int search_id, expansions;
+
+		static inline unsigned int cell_of(long x, long y) {
+			return static_cast<unsigned int>(x | (y << log2_w));
+		}
+		static inline bool is_free(const block_state<log2_w>& state, unsigned int cell) {
+			return ocpncy::get_occ(cell & (TILE_W - 1), cell >> log2_w, state.free);
+		}
+		// Writes a block's state to its place in the spill file and takes it out of its slot
+		void page_out(linked_block* b) {
+			if (b->tile.spill < 0) b->tile.spill = num_spilled++;
+			spill_file.seekp(static_cast<std::streamoff>(b->tile.spill) * sizeof(block_state<log2_w>));
+			spill_file.write(reinterpret_cast<const char*>(&slots[b->tile.slot]->state), sizeof(block_state<log2_w>));
+			if (!spill_file) throw std::ios::failure("Cannot write to spill file");
+			b->tile.slot = -1;
+			num_spills++;
+		}
+		// Gives a block a slot (the least recently used one if they're all taken) and fills it with the block's state
+		void page_in(linked_block* b) {
+			long slot;
+			if (!max_resident || slots.size() < max_resident) {
+				slot = static_cast<long>(slots.size());
+				slots.emplace_back(new resident_slot());
+				lru.push_front(slot);
+				slots[slot]->last_use = lru.begin();
+			}
+			else {
+				slot = lru.back();
+				lru.splice(lru.begin(), lru, slots[slot]->last_use);
+				page_out(slots[slot]->owner);
+			}
+			resident_slot& resident = *slots[slot];
+			resident.owner = b;
+			b->tile.slot = slot;
+			if (b->tile.spill >= 0) {
+				spill_file.seekg(static_cast<std::streamoff>(b->tile.spill) * sizeof(block_state<log2_w>));
+				spill_file.read(reinterpret_cast<char*>(&resident.state), sizeof(block_state<log2_w>));
+				if (!spill_file) throw std::ios::failure("Cannot read spill file");
+			}
+			else {
+				const ocpncy::otile<log2_w>* tile = map->read(b->tile.origin);
+				for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++)
+					resident.state.free.minis[i] = tile ? ~tile->minis[i] : ~static_cast<ocpncy::omini>(0);
+				num_loads++;
+			}
+		}
+		// Returns a block's state for the current search, paging it in first if it isn't resident
+		block_state<log2_w>& get_state(linked_block* b) {
+			if (b->tile.slot < 0) page_in(b);
+			else lru.splice(lru.begin(), lru, slots[b->tile.slot]->last_use);
+			block_state<log2_w>& state = slots[b->tile.slot]->state;
+			if (b->tile.search_id != search_id) {
+				std::fill(state.g, state.g + (1 << (2 * log2_w)), UNREACHED);
+				b->tile.search_id = search_id;
+			}
+			return state;
+		}
+		// Returns the block of the tile at the given origin, allocating and linking it first if it's new
+		linked_block* get_block(const gmtry2i::vector2i& tile_origin) {
+			if (!gmtry2i::contains(bounds, tile_origin)) return 0;
+			linked_block* b = linker->get(tile_origin);
+			if (!b) {
+				search_block new_block = { tile_origin, -1, -1, 0 };
+				linker->write(tile_origin, &new_block);
+				b = linker->get(tile_origin);
+				num_blocks++;
+			}
+			return b;
+		}
+		// Returns the block next to a block in the direction of nbrs[dir], or 0 if it's outside the bounds
+		inline linked_block* get_nbr(linked_block* b, unsigned int dir) {
+			if (b->nbrs[dir]) return b->nbrs[dir];
+			return get_block(b->tile.origin + get_nbr_disp(dir) * TILE_W);
+		}
+		// Octile distance, the cost of the cheapest path on an empty map, which is consistent
+		inline unsigned int get_heuristic(const gmtry2i::vector2i& p, const gmtry2i::vector2i& finish) const {
+			long dx = std::abs(finish.x - p.x), dy = std::abs(finish.y - p.y);
+			long diagonals = std::min(dx, dy);
+			return static_cast<unsigned int>(DIAGONAL_COST * diagonals + STRAIGHT_COST * (std::max(dx, dy) - diagonals));
+		}
+	public:
+		// Searches every tile of the map
+		tile_a_star(maps2::map_istream<ocpncy::otile<log2_w>>* search_map) :
+			tile_a_star(search_map, search_map->get_bounds()) {}
+		// Only searches the tiles of the map in the bounds, which are expanded out to the map's tile borders
+		tile_a_star(maps2::map_istream<ocpncy::otile<log2_w>>* search_map, const gmtry2i::aligned_box2i& search_bounds) {
+			map = search_map;
+			bounds = maps2::align_out(search_bounds, map->get_bounds().min, log2_w);
+			linker.reset(new maps2::nbrng_tile_linker<log2_w, search_block>(bounds.min));
+			max_resident = 0;
+			num_spilled = 0;
+			num_blocks = num_loads = num_spills = 0;
+			search_id = 0;
+			expansions = 0;
+		}
+		/*
+		* Pages search state in and out of a file once more than max_resident blocks have state (at least 9)
+		* The file is created (or emptied) here and deleted with the planner; every block is freed first
+		*/
+		tile_a_star(maps2::map_istream<ocpncy::otile<log2_w>>* search_map, const gmtry2i::aligned_box2i& search_bounds,
+		            size_t max_resident, const std::string& spill_file_name) : tile_a_star(search_map, search_bounds) {
+			this->max_resident = std::max(max_resident, MIN_RESIDENT);
+			this->spill_file_name = spill_file_name;
+			spill_file.open(spill_file_name, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+			if (!(spill_file.is_open())) throw std::ios::failure("Spill file cannot be opened");
+		}
+		gmtry2i::aligned_box2i get_bounds() const {
+			return bounds;
+		}
+		/*
+		* Returns each world-space cell of a shortest path from start to finish (excluding the start),
+		*	or an empty path if the goal can't be reached
+		*/
+		std::vector<gmtry2i::vector2i> generate_path(const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish) {
+			std::vector<gmtry2i::vector2i> path;
+			search_id++;
+			expansions = 0;
+			open = std::priority_queue<open_entry>();
+			if (start.x == finish.x && start.y == finish.y) return path;
+			gmtry2i::vector2i tiles_origin = map->get_bounds().min;
+			linked_block* start_block = get_block(maps2::align_down(start, tiles_origin, log2_w));
+			linked_block* goal_block = get_block(maps2::align_down(finish, tiles_origin, log2_w));
+			if (!start_block || !goal_block) return path;
+			gmtry2i::vector2i local_start = start - start_block->tile.origin, local_goal = finish - goal_block->tile.origin;
+			unsigned int start_cell = cell_of(local_start.x, local_start.y), goal_cell = cell_of(local_goal.x, local_goal.y);
+			if (!is_free(get_state(start_block), start_cell) || !is_free(get_state(goal_block), goal_cell)) return path;
+
+			block_state<log2_w>& start_state = get_state(start_block);
+			start_state.g[start_cell] = 0;
+			start_state.parents[start_cell] = NO_PARENT;
+			open.push({ get_heuristic(start, finish), 0, start_block, start_cell });
+			while (!open.empty()) {
+				open_entry top = open.top();
+				open.pop();
+				// Skip entries that were superseded by a cheaper push
+				if (top.g != get_state(top.block).g[top.cell]) continue;
+				expansions++;
+				if (top.block == goal_block && top.cell == goal_cell) break;
+
+				long x = top.cell & (TILE_W - 1), y = top.cell >> log2_w;
+				for (unsigned int dir = 0; dir < 8; dir++) {
+					gmtry2i::vector2i disp = get_nbr_disp(dir);
+					long next_x = x + disp.x, next_y = y + disp.y;
+					long tile_dx = (next_x >= TILE_W) - (next_x < 0), tile_dy = (next_y >= TILE_W) - (next_y < 0);
+					linked_block* next_block = top.block;
+					// Moves off the tile follow the link to the neighbor in that direction
+					if (tile_dx || tile_dy) {
+						unsigned int tile_dir = (tile_dx + 1) + 3 * (tile_dy + 1);
+						next_block = get_nbr(top.block, tile_dir - (tile_dir > 4));
+						if (!next_block) continue;
+						next_x -= tile_dx * TILE_W;
+						next_y -= tile_dy * TILE_W;
+					}
+					block_state<log2_w>& next_state = get_state(next_block);
+					unsigned int next_cell = cell_of(next_x, next_y);
+					unsigned int new_g = top.g + ((disp.x && disp.y) ? DIAGONAL_COST : STRAIGHT_COST);
+					if (!is_free(next_state, next_cell) || new_g >= next_state.g[next_cell]) continue;
+					next_state.g[next_cell] = new_g;
+					next_state.parents[next_cell] = dir;
+					gmtry2i::vector2i next_p = next_block->tile.origin + gmtry2i::vector2i(next_x, next_y);
+					open.push({ new_g + get_heuristic(next_p, finish), new_g, next_block, next_cell });
+				}
+			}
+			if (get_state(goal_block).g[goal_cell] == UNREACHED) return path;
+
+			// Walk back through the parents, which can only cross into blocks that are already linked
+			linked_block* b = goal_block;
+			unsigned int cell = goal_cell;
+			for (unsigned char dir = get_state(b).parents[cell]; dir != NO_PARENT; dir = get_state(b).parents[cell]) {
+				long x = cell & (TILE_W - 1), y = cell >> log2_w;
+				path.push_back(b->tile.origin + gmtry2i::vector2i(x, y));
+				gmtry2i::vector2i disp = get_nbr_disp(dir);
+				x -= disp.x;
+				y -= disp.y;
+				long tile_dx = (x >= TILE_W) - (x < 0), tile_dy = (y >= TILE_W) - (y < 0);
+				if (tile_dx || tile_dy) {
+					unsigned int tile_dir = (tile_dx + 1) + 3 * (tile_dy + 1);
+					b = b->nbrs[tile_dir - (tile_dir > 4)];
+					x -= tile_dx * TILE_W;
+					y -= tile_dy * TILE_W;
+				}
+				cell = cell_of(x, y);
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+		// Overwrites the occupancy of the tile at the given origin, if the search has reached it
+		void update_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			if (!gmtry2i::contains(bounds, tile_origin)) return;
+			linked_block* b = linker->get(tile_origin);
+			if (!b) return;
+			block_state<log2_w>& state = get_state(b);
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++) state.free.minis[i] = ~tile.minis[i];
+		}
+		// Frees every block; the next search reads its tiles from the map again
+		void clear() {
+			linker.reset(new maps2::nbrng_tile_linker<log2_w, search_block>(bounds.min));
+			slots.clear();
+			lru.clear();
+			num_spilled = 0;
+			num_blocks = 0;
+		}
+		// Returns the number of nodes expanded by the last search
+		unsigned int get_expansions() const {
+			return expansions;
+		}
+		// Returns the number of blocks allocated so far
+		size_t get_num_blocks() const {
+			return num_blocks;
+		}
+		// Returns the number of blocks whose state is resident
+		size_t get_num_resident() const {
+			return slots.size();
+		}
+		// Returns the number of tiles read from the map and the number of states written to the spill file so far
+		size_t get_num_loads() const {
+			return num_loads;
+		}
+		size_t get_num_spills() const {
+			return num_spills;
+		}
+		// Returns the number of bytes taken by the blocks and the resident states (not counting the tree)
+		size_t get_memory_usage() const {
+			return num_blocks * sizeof(linked_block) + slots.size() * sizeof(resident_slot);
+		}
+		~tile_a_star() {
+			if (spill_file.is_open()) {
+				spill_file.close();
+				std::remove(spill_file_name.c_str());
+			}
+		}
+	};
+}
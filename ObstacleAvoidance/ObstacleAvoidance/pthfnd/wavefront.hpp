@@ -0,0 +1,257 @@
+#pragma once
+
+#include "../ocpncy/occupancy.hpp"
+#include "../maps2/tilemaps2.hpp"
+#include "../maps2/maps2_streams.hpp"
+
+#include <stdint.h>
+#include <bit>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+/*
+* Breadth-first wavefronts over binary occupancy tiles.
+* Every cell of a wave's frontier is expanded at once by dilating whole minis (64 cells per word) with shifts and ORs,
+*	then masking the result with the free cells, so a step of the wave costs a few word operations per mini
+*	instead of a queue operation per cell.
+* A wave grows by one ring of 8-connected moves per step, which only measures uniform costs, so every move counts as one
+*	step whether it is straight or diagonal, and the step at which a cell is reached is its exact distance.
+*/
+namespace pthfnd {
+	// Step count of a cell that no wave has reached
+	const unsigned int UNREACHED = static_cast<unsigned int>(-1);
+
+	// Bits of the first and last column of a mini
+	const ocpncy::omini MINI_FIRST_COL = 0x0101010101010101ULL;
+	const ocpncy::omini MINI_LAST_COL = 0x8080808080808080ULL;
+
+	// Spreads every state of a mini one cell along its row, taking in the edge columns of the minis on either side
+	inline ocpncy::omini spread_row(ocpncy::omini left, ocpncy::omini m, ocpncy::omini right) {
+		return m | ((m << 1) & ~MINI_FIRST_COL) | ((m >> 1) & ~MINI_LAST_COL) |
+		       ((left & MINI_LAST_COL) >> (ocpncy::MINI_WIDTH - 1)) | ((right & MINI_FIRST_COL) << (ocpncy::MINI_WIDTH - 1));
+	}
+	// Spreads every state of a mini one cell along its column, taking in the edge rows of the minis below and above it
+	inline ocpncy::omini spread_col(ocpncy::omini below, ocpncy::omini m, ocpncy::omini above) {
+		return m | (m << ocpncy::MINI_WIDTH) | (m >> ocpncy::MINI_WIDTH) |
+		       (below >> (ocpncy::MINI_AREA - ocpncy::MINI_WIDTH)) | (above << (ocpncy::MINI_AREA - ocpncy::MINI_WIDTH));
+	}
+
+	// Gives every cell set in a tile's mini the step count (steps are indexed by compress_coords2)
+	template <unsigned int log2_w>
+	inline void set_steps(unsigned int* steps, unsigned int mini_idx, ocpncy::omini m, unsigned int step) {
+		unsigned int mini_x = (mini_idx & (ocpncy::get_tile_width_minis(log2_w) - 1)) << ocpncy::LOG2_MINIW;
+		unsigned int mini_y = (mini_idx >> (log2_w - ocpncy::LOG2_MINIW)) << ocpncy::LOG2_MINIW;
+		// Only the cells that are set are visited one at a time
+		for (; m; m &= m - 1) {
+			unsigned int bit_idx = std::countr_zero(m);
+			unsigned int x = mini_x | (bit_idx & ocpncy::MINI_COORD_MASK), y = mini_y | (bit_idx >> ocpncy::LOG2_MINIW);
+			steps[x | (y << log2_w)] = step;
+		}
+	}
+
+	/*
+	* Wave confined to a single tile, from the source cells through the free cells
+	* Fills in every cell's step count (indexed by compress_coords2), which is UNREACHED where the wave doesn't get to
+	*/
+	template <unsigned int log2_w>
+	void tile_wavefront(const ocpncy::otile<log2_w>& free, const ocpncy::otile<log2_w>& sources, unsigned int* steps) {
+		const int tile_w_minis = ocpncy::get_tile_width_minis(log2_w);
+		ocpncy::otile<log2_w> reached, frontier, next;
+		// Returns a mini of the frontier, where minis past the tile's edges are empty
+		auto frontier_mini = [&frontier, tile_w_minis](int mx, int my) -> ocpncy::omini {
+			if (mx < 0 || my < 0 || mx >= tile_w_minis || my >= tile_w_minis) return 0;
+			return frontier.minis[mx | (my << (log2_w - ocpncy::LOG2_MINIW))];
+		};
+		std::fill(steps, steps + (1 << (2 * log2_w)), UNREACHED);
+		for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++)
+			reached.minis[i] = frontier.minis[i] = sources.minis[i] & free.minis[i];
+		for (unsigned int step = 0; ocpncy::is_occupied(frontier); step++) {
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++) set_steps<log2_w>(steps, i, frontier.minis[i], step);
+			for (int my = 0; my < tile_w_minis; my++) for (int mx = 0; mx < tile_w_minis; mx++) {
+				ocpncy::omini spread[3];
+				for (int dy = -1; dy <= 1; dy++)
+					spread[dy + 1] = spread_row(frontier_mini(mx - 1, my + dy), frontier_mini(mx, my + dy), frontier_mini(mx + 1, my + dy));
+				unsigned int mini_idx = mx | (my << (log2_w - ocpncy::LOG2_MINIW));
+				next.minis[mini_idx] = spread_col(spread[0], spread[1], spread[2]) & free.minis[mini_idx] & ~reached.minis[mini_idx];
+			}
+			frontier = next;
+			reached += next;
+		}
+	}
+
+	/*
+	* Wave state of one tile, laid out like an otile so the masks can be handed out as occupancy tiles
+	* Steps are indexed by compress_coords2 and only mean something where the reached bit is set
+	*/
+	template <unsigned int log2_w>
+	struct wave_tile {
+		ocpncy::otile<log2_w> free, reached, frontier, next;
+		unsigned int steps[1 << (2 * log2_w)];
+		// Last step of the wave that this tile was expanded in
+		unsigned int last_step;
+	};
+
+	/*
+	* Distance transform of a region of a tile map, in steps from a set of source cells
+	* The map's tiles are copied into a grid of linked tiles, so the wave crosses tile borders by following
+	*	neighbor links instead of searching the tree. Only tiles inside the region are linked and anything outside of
+	*	it is occupied; space in the region that has no tile is unoccupied.
+	*/
+	template <unsigned int log2_w>
+	class wavefront {
+		typedef maps2::nbrng_tile<wave_tile<log2_w>> linked_tile;
+		static constexpr int TILE_W_MINIS = ocpncy::get_tile_width_minis(log2_w);
+		static constexpr int PADDED_W_MINIS = TILE_W_MINIS + 2;
+
+		gmtry2i::aligned_box2i bounds;
+		maps2::nbrng_tile_linker<log2_w, wave_tile<log2_w>> linker;
+		std::vector<linked_tile*> tiles, active, expanding;
+		unsigned int num_steps;
+
+		// Returns the frontier mini at mini coordinates (mx, my) of a tile, which may be one mini into a neighbor
+		static inline ocpncy::omini frontier_mini(const linked_tile* t, int mx, int my) {
+			int dx = (mx >= TILE_W_MINIS) - (mx < 0), dy = (my >= TILE_W_MINIS) - (my < 0);
+			if (dx || dy) {
+				unsigned int nbr_idx = (dx + 1) + 3 * (dy + 1);
+				t = t->nbrs[nbr_idx - (nbr_idx > 4)];
+				if (!t) return 0;
+				mx -= dx * TILE_W_MINIS;
+				my -= dy * TILE_W_MINIS;
+			}
+			return t->tile.frontier.minis[mx | (my << (log2_w - ocpncy::LOG2_MINIW))];
+		}
+		// Finds the newly reached cells of a tile by dilating its frontier, padded with the edges of its neighbors'
+		static void dilate(linked_tile* t) {
+			ocpncy::omini padded[PADDED_W_MINIS * PADDED_W_MINIS], spread[PADDED_W_MINIS * TILE_W_MINIS];
+			for (int py = 0; py < PADDED_W_MINIS; py++) for (int px = 0; px < PADDED_W_MINIS; px++)
+				padded[px + py * PADDED_W_MINIS] = frontier_mini(t, px - 1, py - 1);
+			for (int py = 0; py < PADDED_W_MINIS; py++) for (int mx = 0; mx < TILE_W_MINIS; mx++) {
+				const ocpncy::omini* row = &padded[mx + py * PADDED_W_MINIS];
+				spread[mx + py * TILE_W_MINIS] = spread_row(row[0], row[1], row[2]);
+			}
+			wave_tile<log2_w>& wt = t->tile;
+			for (int my = 0; my < TILE_W_MINIS; my++) for (int mx = 0; mx < TILE_W_MINIS; mx++) {
+				const ocpncy::omini* col = &spread[mx + my * TILE_W_MINIS];
+				unsigned int mini_idx = mx | (my << (log2_w - ocpncy::LOG2_MINIW));
+				wt.next.minis[mini_idx] = spread_col(col[0], col[TILE_W_MINIS], col[2 * TILE_W_MINIS]) &
+				                          wt.free.minis[mini_idx] & ~wt.reached.minis[mini_idx];
+			}
+		}
+		// Makes a tile's newly reached cells its frontier, gives them their step count and returns whether there were any
+		static bool advance(linked_tile* t, unsigned int step) {
+			wave_tile<log2_w>& wt = t->tile;
+			bool any_reached = false;
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++) {
+				ocpncy::omini m = wt.next.minis[i];
+				wt.frontier.minis[i] = m;
+				wt.reached.minis[i] |= m;
+				any_reached |= (m != 0);
+				set_steps<log2_w>(wt.steps, i, m, step);
+			}
+			return any_reached;
+		}
+		// Returns the linked tile containing the world-space point, or 0 if it's outside the region
+		inline linked_tile* get_linked_tile(const gmtry2i::vector2i& p) {
+			if (!gmtry2i::contains(bounds, p)) return 0;
+			return linker.get(p);
+		}
+	public:
+		/*
+		* Reads every tile of the map that lies in the bounds
+		* Bounds are expanded out to the map's tile borders
+		*/
+		wavefront(maps2::map_istream<ocpncy::otile<log2_w>>* map, const gmtry2i::aligned_box2i& wave_bounds) :
+			bounds(maps2::align_out(wave_bounds, map->get_bounds().min, log2_w)), linker(bounds.min) {
+			const long tile_w = 1 << log2_w;
+			// The template tile holds a step count per cell, which is too much for the stack when tiles are large
+			std::unique_ptr<wave_tile<log2_w>> wt(new wave_tile<log2_w>());
+			for (long y = bounds.min.y; y < bounds.max.y; y += tile_w) for (long x = bounds.min.x; x < bounds.max.x; x += tile_w) {
+				gmtry2i::vector2i tile_origin(x, y);
+				const ocpncy::otile<log2_w>* tile = map->read(tile_origin);
+				for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++)
+					wt->free.minis[i] = tile ? ~tile->minis[i] : ~static_cast<ocpncy::omini>(0);
+				linker.write(tile_origin, wt.get());
+				tiles.push_back(linker.get(tile_origin));
+			}
+			num_steps = 0;
+		}
+		gmtry2i::aligned_box2i get_bounds() const {
+			return bounds;
+		}
+		// Forgets every source and step count
+		void reset() {
+			for (linked_tile* t : tiles) {
+				t->tile.reached = t->tile.frontier = t->tile.next = ocpncy::otile<log2_w>();
+				t->tile.last_step = 0;
+			}
+			active.clear();
+			num_steps = 0;
+		}
+		// Adds a cell that is 0 steps away; returns false if it's occupied or outside the region
+		bool add_source(const gmtry2i::vector2i& p) {
+			linked_tile* t = get_linked_tile(p);
+			if (!t) return false;
+			gmtry2i::vector2i local_p = p - bounds.min;
+			unsigned int x = local_p.x & ocpncy::get_tile_coord_mask(log2_w), y = local_p.y & ocpncy::get_tile_coord_mask(log2_w);
+			if (!ocpncy::get_occ(x, y, t->tile.free)) return false;
+			ocpncy::put_occ(x, y, t->tile.reached);
+			ocpncy::put_occ(x, y, t->tile.frontier);
+			t->tile.steps[x | (y << log2_w)] = num_steps;
+			active.push_back(t);
+			return true;
+		}
+		/*
+		* Advances the wave until it stops reaching new cells or has taken max_steps steps in total
+		* Every step dilates the frontier tiles and their neighbors, each tile once, before any of them advance
+		*/
+		void propagate(unsigned int max_steps = UNREACHED) {
+			while (!active.empty() && num_steps < max_steps) {
+				num_steps++;
+				expanding.clear();
+				for (linked_tile* t : active) {
+					for (int i = -1; i < 8; i++) {
+						linked_tile* nbr = (i < 0) ? t : t->nbrs[i];
+						if (nbr && nbr->tile.last_step != num_steps) {
+							nbr->tile.last_step = num_steps;
+							expanding.push_back(nbr);
+						}
+					}
+				}
+				for (linked_tile* t : expanding) dilate(t);
+				active.clear();
+				for (linked_tile* t : expanding) if (advance(t, num_steps)) active.push_back(t);
+				// The last step didn't reach anything
+				if (active.empty()) num_steps--;
+			}
+		}
+		// Computes every cell's step count from a single source
+		void compute(const gmtry2i::vector2i& source, unsigned int max_steps = UNREACHED) {
+			reset();
+			if (add_source(source)) propagate(max_steps);
+		}
+		// Returns the number of steps from the nearest source to the world-space cell (UNREACHED if it wasn't reached)
+		unsigned int get_steps(const gmtry2i::vector2i& p) {
+			linked_tile* t = get_linked_tile(p);
+			if (!t) return UNREACHED;
+			gmtry2i::vector2i local_p = p - bounds.min;
+			unsigned int x = local_p.x & ocpncy::get_tile_coord_mask(log2_w), y = local_p.y & ocpncy::get_tile_coord_mask(log2_w);
+			return ocpncy::get_occ(x, y, t->tile.reached) ? t->tile.steps[x | (y << log2_w)] : UNREACHED;
+		}
+		// Returns the mask of reached cells of the tile containing the point, or 0 if it's outside the region
+		const ocpncy::otile<log2_w>* get_reached(const gmtry2i::vector2i& p) {
+			linked_tile* t = get_linked_tile(p);
+			return t ? &(t->tile.reached) : 0;
+		}
+		// Overwrites the occupancy of the tile at the given origin; takes effect from the next computation
+		void update_tile(const gmtry2i::vector2i& tile_origin, const ocpncy::otile<log2_w>& tile) {
+			linked_tile* t = get_linked_tile(tile_origin);
+			if (!t) return;
+			for (int i = 0; i < ocpncy::get_tile_area_minis(log2_w); i++) t->tile.free.minis[i] = ~tile.minis[i];
+		}
+		// Returns the number of steps the wave has taken since the last reset (the most steps any cell is from a source)
+		unsigned int get_num_steps() const {
+			return num_steps;
+		}
+	};
+}
@@ -179,12 +179,12 @@ bool** read_maze_file(FILE* in_file) {
 }
 
 // Writes the maze solution into a pbm file
-void write_maze_sol(FILE* out_file, node_t** node_map, vector<tuple<int, int>> path, int nrows, int ncols) {
+void write_maze_sol(FILE* out_file, NodeGrid* grid, vector<tuple<int, int>> path, int nrows, int ncols) {
 	fprintf(out_file, "P3\n%d %d\n255\n", nrows, ncols);
 	int filled; bool part_of_sol;
 	for (int row = 0; row < nrows; row++) {
 		for (int col = 0; col < ncols; col++) {
-			filled = 255 * CNode::get_occupancy(&node_map[row][col]);
+			filled = 255 * grid->get_occupancy(grid->index(row, col));
 
 			if (filled == 0) {
 				part_of_sol = false;
@@ -1,5 +1,7 @@
 // Imports
-#include "../header.hh";
+#include "../grid_search.hpp"
+#include "../tile_maze.hpp"
+#include "../maps2/maps2_streams.hpp"
 
 
 // Tests the AStar algorithm
@@ -129,4 +131,953 @@ void test_DStar(const char* out_file_name, bool input_file_exists, const char* i
 	// Cleaning up resources
 	fclose(out_file);
 	out_file = NULL;
-}
\ No newline at end of file
+}
+
+/*
+ * Benchmarks DStar replanning against fresh AStar searches. Each scripted edit
+ * moves the start one step along the current path and drops a 3x3 obstacle
+ * onto the path further ahead, after which both planners produce a new path.
+ */
+void benchmark_DStar_replanning(int nrows, int ncols, double density, int num_edits) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+
+	int start_x = 0, start_y = 0, goal_x = nrows - 1, goal_y = ncols - 1;
+	maze[start_x][start_y] = false;
+	maze[goal_x][goal_y] = false;
+
+	// Initial plan
+	DStar dstar = DStar(maze, nrows, ncols, start_x, start_y, goal_x, goal_y);
+	auto start = high_resolution_clock::now();
+	vector<tuple<int, int>> path = dstar.generate_path();
+	auto stop = high_resolution_clock::now();
+	printf("Initial DStar plan: %lld us, %d expansions, path length %d\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), dstar.get_expansions(), (int) path.size());
+
+	long long dstar_total = 0, astar_total = 0;
+	int mismatches = 0;
+	for (int edit = 0; (edit < num_edits) && (path.size() > 4); edit++) {
+		// Moving the start one step forward
+		start_x = get<0>(path[0]);
+		start_y = get<1>(path[0]);
+
+		// Blocking the path a third of the way ahead
+		tuple<int, int> blocked = path[path.size() / 3];
+		vector<tuple<int, int>> changed;
+		for (int d_row = -1; d_row <= 1; d_row++) {
+			for (int d_col = -1; d_col <= 1; d_col++) {
+				int row = get<0>(blocked) + d_row, col = get<1>(blocked) + d_col;
+				if ((row < 0) || (col < 0) || (row >= nrows) || (col >= ncols) ||
+					((row == start_x) && (col == start_y)) || ((row == goal_x) && (col == goal_y))) {
+					continue;
+				}
+				maze[row][col] = true;
+				changed.push_back(make_tuple(row, col));
+			}
+		}
+
+		// Incremental replan
+		int prev_expansions = dstar.get_expansions();
+		start = high_resolution_clock::now();
+		dstar.update_start(start_x, start_y);
+		for (tuple<int, int> cell : changed) {
+			dstar.update_occupancy(get<0>(cell), get<1>(cell), true);
+		}
+		path = dstar.generate_path();
+		stop = high_resolution_clock::now();
+		long long dstar_time = duration_cast<microseconds>(stop - start).count();
+		dstar_total += dstar_time;
+
+		// Fresh search
+		start = high_resolution_clock::now();
+		AStar astar = AStar(maze, nrows, ncols, start_x, start_y, goal_x, goal_y);
+		vector<tuple<int, int>> astar_path = astar.generate_path();
+		stop = high_resolution_clock::now();
+		long long astar_time = duration_cast<microseconds>(stop - start).count();
+		astar_total += astar_time;
+
+		int dstar_cost = NodeGrid::get_path_cost(start_x, start_y, path);
+		int astar_cost = NodeGrid::get_path_cost(start_x, start_y, astar_path);
+		if (astar_cost != dstar_cost) {
+			mismatches++;
+		}
+		printf("Edit %d: DStar %lld us (%d expansions), AStar %lld us, path cost %d vs %d\n", edit, dstar_time,
+			dstar.get_expansions() - prev_expansions, astar_time, dstar_cost, astar_cost);
+	}
+
+	printf("Total replanning time: DStar %lld us, AStar %lld us, %d cost mismatches\n", dstar_total, astar_total, mismatches);
+}
+
+
+// Compares JPS against AStar (path cost, expansions and time) on random mazes
+void test_JPS(int nrows, int ncols, double density, int num_trials) {
+	long long astar_total = 0, jps_total = 0;
+	long long astar_expansions = 0, jps_expansions = 0;
+	int mismatches = 0;
+
+	for (int trial = 0; trial < num_trials; trial++) {
+		bool** maze = create_maze(nrows, ncols, density);
+		if (maze == NULL) {
+			return;
+		}
+		maze[0][0] = false;
+		maze[nrows - 1][ncols - 1] = false;
+
+		AStar astar = AStar(maze, nrows, ncols);
+		auto start = high_resolution_clock::now();
+		vector<tuple<int, int>> astar_path = astar.generate_path();
+		auto stop = high_resolution_clock::now();
+		astar_total += duration_cast<microseconds>(stop - start).count();
+		astar_expansions += astar.get_expansions();
+
+		JPS jps = JPS(maze, nrows, ncols);
+		start = high_resolution_clock::now();
+		vector<tuple<int, int>> jps_path = jps.generate_path();
+		stop = high_resolution_clock::now();
+		jps_total += duration_cast<microseconds>(stop - start).count();
+		jps_expansions += jps.get_expansions();
+
+		int astar_cost = NodeGrid::get_path_cost(0, 0, astar_path), jps_cost = NodeGrid::get_path_cost(0, 0, jps_path);
+		if (astar_cost != jps_cost) {
+			mismatches++;
+			printf("Trial %d: path cost mismatch, AStar %d vs JPS %d\n", trial, astar_cost, jps_cost);
+		}
+	}
+
+	printf("AStar: %lld us, %lld expansions\n", astar_total, astar_expansions);
+	printf("JPS: %lld us, %lld expansions\n", jps_total, jps_expansions);
+	printf("%d of %d trials had different path costs\n", mismatches, num_trials);
+}
+
+
+// Per-node layout the planners used before NodeGrid (array of structs, one malloc per row)
+typedef struct legacy_node {
+	int x, y;
+	unsigned int cost;
+	float heuristic;
+	float rhs;
+	int heap_index;
+} legacy_node_t;
+
+/*
+ * Compares the old array-of-structs node map against the flat NodeGrid on
+ * memory, initialization and a full sweep over the costs, then times every
+ * planner on the same maze (e.g. 4096 x 4096).
+ */
+void benchmark_node_grid(int nrows, int ncols, double density) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	// Old layout
+	auto start = high_resolution_clock::now();
+	legacy_node_t** legacy = (legacy_node_t**) allocate_2d_arr(nrows, ncols, sizeof(legacy_node_t));
+	if (legacy == NULL) {
+		fprintf(stderr, "Problem allocating memory for the legacy node map.\n");
+		return;
+	}
+	for (int row = 0; row < nrows; row++) {
+		for (int col = 0; col < ncols; col++) {
+			legacy[row][col] = { row, col, (unsigned int) ((max_cost & (~1)) | maze[row][col]), max_heuristic, max_rhs, -1 };
+		}
+	}
+	auto stop = high_resolution_clock::now();
+	long long legacy_init = duration_cast<microseconds>(stop - start).count();
+
+	long long legacy_sum = 0;
+	start = high_resolution_clock::now();
+	for (int row = 0; row < nrows; row++) {
+		for (int col = 0; col < ncols; col++) {
+			legacy_sum += legacy[row][col].cost & 1;
+		}
+	}
+	stop = high_resolution_clock::now();
+	long long legacy_sweep = duration_cast<microseconds>(stop - start).count();
+	size_t legacy_bytes = (sizeof(legacy_node_t*) * nrows) + (sizeof(legacy_node_t) * (size_t) nrows * ncols);
+
+	for (int row = 0; row < nrows; row++) {
+		free(legacy[row]);
+	}
+	free(legacy);
+
+	// Flat layout
+	start = high_resolution_clock::now();
+	NodeGrid grid = NodeGrid(nrows, ncols, maze);
+	stop = high_resolution_clock::now();
+	long long grid_init = duration_cast<microseconds>(stop - start).count();
+
+	long long grid_sum = 0;
+	start = high_resolution_clock::now();
+	for (int row = 0; row < nrows; row++) {
+		for (int col = 0; col < ncols; col++) {
+			grid_sum += grid.get_occupancy(grid.index(row, col));
+		}
+	}
+	stop = high_resolution_clock::now();
+	long long grid_sweep = duration_cast<microseconds>(stop - start).count();
+
+	printf("Legacy node map: %zu bytes, init %lld us, occupancy sweep %lld us (%lld occupied)\n",
+		legacy_bytes, legacy_init, legacy_sweep, legacy_sum);
+	printf("NodeGrid: %zu bytes, init %lld us, occupancy sweep %lld us (%lld occupied)\n",
+		grid.get_memory_usage(), grid_init, grid_sweep, grid_sum);
+
+	// Planners on the flat layout
+	start = high_resolution_clock::now();
+	AStar astar = AStar(maze, nrows, ncols);
+	vector<tuple<int, int>> path = astar.generate_path();
+	stop = high_resolution_clock::now();
+	printf("AStar: %lld us, %d expansions, path cost %d\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), astar.get_expansions(), NodeGrid::get_path_cost(0, 0, path));
+
+	start = high_resolution_clock::now();
+	Dijkstra dijkstra = Dijkstra(maze, nrows, ncols);
+	path = dijkstra.generate_path();
+	stop = high_resolution_clock::now();
+	printf("Dijkstra: %lld us, path cost %d\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), NodeGrid::get_path_cost(0, 0, path));
+
+	start = high_resolution_clock::now();
+	DStar dstar = DStar(maze, nrows, ncols);
+	path = dstar.generate_path();
+	stop = high_resolution_clock::now();
+	printf("DStar: %lld us, %d expansions, path cost %d\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), dstar.get_expansions(), NodeGrid::get_path_cost(0, 0, path));
+}
+
+
+/*
+ * Plans between random start/goal pairs on one maze, once by building a new
+ * AStar for every pair and once by reusing a single AStar, whose grid only
+ * reinitializes the nodes each search reaches.
+ */
+void benchmark_workspace_reuse(int nrows, int ncols, double density, int num_plans) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+
+	vector<tuple<int, int, int, int>> pairs;
+	for (int plan = 0; plan < num_plans; plan++) {
+		int start_x = rand() % nrows, start_y = rand() % ncols;
+		int goal_x = min(nrows - 1, start_x + (rand() % 64)), goal_y = min(ncols - 1, start_y + (rand() % 64));
+		maze[start_x][start_y] = false;
+		maze[goal_x][goal_y] = false;
+		pairs.push_back(make_tuple(start_x, start_y, goal_x, goal_y));
+	}
+
+	// New planner per pair
+	long long fresh_total = 0;
+	vector<size_t> fresh_lengths;
+	for (tuple<int, int, int, int> pair : pairs) {
+		auto start = high_resolution_clock::now();
+		AStar astar = AStar(maze, nrows, ncols, get<0>(pair), get<1>(pair), get<2>(pair), get<3>(pair));
+		fresh_lengths.push_back(astar.generate_path().size());
+		auto stop = high_resolution_clock::now();
+		fresh_total += duration_cast<microseconds>(stop - start).count();
+	}
+
+	// One reused planner
+	long long reused_total = 0;
+	int mismatches = 0;
+	AStar workspace = AStar(maze, nrows, ncols);
+	for (int plan = 0; plan < num_plans; plan++) {
+		tuple<int, int, int, int> pair = pairs[plan];
+		auto start = high_resolution_clock::now();
+		size_t length = workspace.generate_path(get<0>(pair), get<1>(pair), get<2>(pair), get<3>(pair)).size();
+		auto stop = high_resolution_clock::now();
+		reused_total += duration_cast<microseconds>(stop - start).count();
+		if (length != fresh_lengths[plan]) {
+			mismatches++;
+		}
+	}
+
+	printf("%d plans: new AStar each time %lld us, reused AStar %lld us, %d path length mismatches\n",
+		num_plans, fresh_total, reused_total, mismatches);
+}
+
+
+/*
+ * Runs the anytime AStar with a tight deadline and with a generous one on a
+ * random maze. The tight run's path must be within its reported bound of the
+ * optimal cost, and the generous run must reach a bound of 1 and the optimum.
+ */
+void test_ARAStar(int nrows, int ncols, double density, int deadline_us) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	AStar optimal = AStar(maze, nrows, ncols);
+	int optimal_cost = NodeGrid::get_path_cost(0, 0, optimal.generate_path());
+
+	AStar anytime = AStar(maze, nrows, ncols);
+	auto start = steady_clock::now();
+	vector<tuple<int, int>> path = anytime.generate_path(start + microseconds(deadline_us), 3.0f, 0.5f);
+	auto stop = steady_clock::now();
+	int cost = NodeGrid::get_path_cost(0, 0, path);
+	float bound = anytime.get_suboptimality_bound();
+	if (path.empty()) {
+		printf("ARA* with a %d us deadline: no path before the deadline (%lld us)\n", deadline_us,
+			(long long) duration_cast<microseconds>(stop - start).count());
+	}
+	else {
+		bool within_bound = cost <= (bound * optimal_cost) + 0.001f;
+		printf("ARA* with a %d us deadline: %lld us, cost %d (optimal %d), bound %.3f, %s\n", deadline_us,
+			(long long) duration_cast<microseconds>(stop - start).count(), cost, optimal_cost, bound,
+			within_bound ? "within bound" : "NOT within bound");
+	}
+
+	start = steady_clock::now();
+	path = anytime.generate_path(start + seconds(60), 3.0f, 0.5f);
+	stop = steady_clock::now();
+	cost = NodeGrid::get_path_cost(0, 0, path);
+	bound = anytime.get_suboptimality_bound();
+	printf("ARA* with no practical deadline: %lld us, cost %d (optimal %d), bound %.3f, %s\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), cost, optimal_cost, bound,
+		((bound == 1) && (cost == optimal_cost)) ? "optimal" : "NOT optimal");
+}
+
+
+/*
+ * Runs AStar, Dijkstra and DStar in slices of slice_size expansions, like a
+ * frame loop would between map updates, and checks each against the path
+ * its one-shot generate_path finds.
+ */
+void test_step_search(int nrows, int ncols, double density, int slice_size) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	AStar astar = AStar(maze, nrows, ncols);
+	size_t astar_length = AStar(maze, nrows, ncols).generate_path().size();
+	int slices = 0;
+	size_t partial_length = 0;
+	astar.start_search();
+	while (astar.step(slice_size) == SEARCH_IN_PROGRESS) {
+		partial_length = astar.get_partial_path().size();
+		slices++;
+	}
+	printf("AStar: %d slices, last partial path %zu steps, %s, path %zu steps (one-shot %zu)\n", slices, partial_length,
+		(astar.get_status() == SEARCH_FOUND) ? "found" : "unreachable", astar.get_partial_path().size(), astar_length);
+
+	Dijkstra dijkstra = Dijkstra(maze, nrows, ncols);
+	size_t dijkstra_length = Dijkstra(maze, nrows, ncols).generate_path().size();
+	slices = 0;
+	partial_length = 0;
+	dijkstra.start_search();
+	while (dijkstra.step(slice_size) == SEARCH_IN_PROGRESS) {
+		partial_length = dijkstra.get_partial_path().size();
+		slices++;
+	}
+	printf("Dijkstra: %d slices, last partial path %zu steps, %s, path %zu steps (one-shot %zu)\n", slices, partial_length,
+		(dijkstra.get_status() == SEARCH_FOUND) ? "found" : "unreachable", dijkstra.get_partial_path().size(), dijkstra_length);
+
+	DStar dstar = DStar(maze, nrows, ncols);
+	size_t dstar_length = DStar(maze, nrows, ncols).generate_path().size();
+	slices = 0;
+	while (dstar.step(slice_size) == SEARCH_IN_PROGRESS) {
+		slices++;
+	}
+	printf("DStar: %d slices, %s, path %zu steps (one-shot %zu)\n", slices,
+		(dstar.get_status() == SEARCH_FOUND) ? "found" : "unreachable", dstar.get_partial_path().size(), dstar_length);
+}
+
+
+/*
+ * Answers num_starts random start queries to one goal with a DistanceField
+ * and with a reused AStar, then flips num_edits random cells and repeats the
+ * queries after the field's incremental repair. Path costs are compared.
+ */
+void benchmark_distance_field(int nrows, int ncols, double density, int num_starts, int num_edits) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	int goal_x = nrows / 2, goal_y = ncols / 2;
+	maze[goal_x][goal_y] = false;
+
+	vector<tuple<int, int>> starts;
+	for (int query = 0; query < num_starts; query++) {
+		int start_x = rand() % nrows, start_y = rand() % ncols;
+		maze[start_x][start_y] = false;
+		starts.push_back(make_tuple(start_x, start_y));
+	}
+
+	auto start = high_resolution_clock::now();
+	DistanceField field = DistanceField(maze, nrows, ncols, goal_x, goal_y);
+	auto stop = high_resolution_clock::now();
+	printf("DistanceField build: %lld us, %d expansions\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), field.get_expansions());
+
+	AStar astar = AStar(maze, nrows, ncols);
+	for (int round = 0; round < 2; round++) {
+		long long field_total = 0, astar_total = 0;
+		int mismatches = 0;
+		for (tuple<int, int> query : starts) {
+			start = high_resolution_clock::now();
+			int field_cost = NodeGrid::get_path_cost(get<0>(query), get<1>(query), field.generate_path(get<0>(query), get<1>(query)));
+			stop = high_resolution_clock::now();
+			field_total += duration_cast<microseconds>(stop - start).count();
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> astar_path = astar.generate_path(get<0>(query), get<1>(query), goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			astar_total += duration_cast<microseconds>(stop - start).count();
+
+			if (field_cost != NodeGrid::get_path_cost(get<0>(query), get<1>(query), astar_path)) {
+				mismatches++;
+			}
+		}
+		printf("%d queries: DistanceField %lld us, AStar %lld us, %d path cost mismatches\n",
+			num_starts, field_total, astar_total, mismatches);
+
+		if (round == 0) {
+			// Flipping random cells (never the goal or a start) and repairing the field
+			int expansions_before = field.get_expansions();
+			start = high_resolution_clock::now();
+			for (int edit = 0; edit < num_edits; edit++) {
+				int row = rand() % nrows, col = rand() % ncols;
+				if (((row == goal_x) && (col == goal_y)) ||
+					(find(starts.begin(), starts.end(), make_tuple(row, col)) != starts.end())) {
+					continue;
+				}
+				maze[row][col] = !maze[row][col];
+				field.update_occupancy(row, col, maze[row][col]);
+			}
+			field.get_cost_to_go(goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			astar.update_occupancy_map(maze);
+			printf("%d edits: DistanceField repair %lld us, %d expansions\n", num_edits,
+				(long long) duration_cast<microseconds>(stop - start).count(), field.get_expansions() - expansions_before);
+		}
+	}
+}
+
+
+// Times one GridSearch instantiation corner to corner and prints its cost and expansions
+template <typename heuristic_t, typename queue_t, int connectivity>
+static void time_search_policy(const char* name, bool** maze, int nrows, int ncols) {
+	GridSearch<heuristic_t, queue_t, connectivity> search = GridSearch<heuristic_t, queue_t, connectivity>(maze, nrows, ncols);
+	auto start = high_resolution_clock::now();
+	vector<tuple<int, int>> path = search.generate_path();
+	auto stop = high_resolution_clock::now();
+	printf("%-44s %10lld us, path cost %d, %d expansions\n", name,
+		(long long) duration_cast<microseconds>(stop - start).count(), NodeGrid::get_path_cost(0, 0, path), search.get_expansions());
+}
+
+/*
+ * Benchmark matrix over the search engine's policies on one maze: every
+ * heuristic with the binary heap, the integer ones with the bucket queue, all
+ * with 8 and 4 connectivity. Paths of the same connectivity should cost the same.
+ */
+void benchmark_search_policies(int nrows, int ncols, double density) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	time_search_policy<zero_heuristic<>, NodePriorityQueue, 8>("zero, NodePriorityQueue, 8-connected", maze, nrows, ncols);
+	time_search_policy<zero_heuristic<>, BucketQueue, 8>("zero, BucketQueue, 8-connected", maze, nrows, ncols);
+	time_search_policy<euclidean_heuristic<>, NodePriorityQueue, 8>("euclidean, NodePriorityQueue, 8-connected", maze, nrows, ncols);
+	time_search_policy<octile_heuristic<>, NodePriorityQueue, 8>("octile, NodePriorityQueue, 8-connected", maze, nrows, ncols);
+	time_search_policy<octile_heuristic<>, BucketQueue, 8>("octile, BucketQueue, 8-connected", maze, nrows, ncols);
+	time_search_policy<zero_heuristic<>, NodePriorityQueue, 4>("zero, NodePriorityQueue, 4-connected", maze, nrows, ncols);
+	time_search_policy<zero_heuristic<>, BucketQueue, 4>("zero, BucketQueue, 4-connected", maze, nrows, ncols);
+	time_search_policy<euclidean_heuristic<>, NodePriorityQueue, 4>("euclidean, NodePriorityQueue, 4-connected", maze, nrows, ncols);
+	time_search_policy<octile_heuristic<>, NodePriorityQueue, 4>("octile, NodePriorityQueue, 4-connected", maze, nrows, ncols);
+	time_search_policy<octile_heuristic<>, BucketQueue, 4>("octile, BucketQueue, 4-connected", maze, nrows, ncols);
+}
+
+
+/*
+ * Times AStar (with either queue) against BidirectionalAStar (on one thread
+ * and on two) over the same random far-apart queries on clustered mazes of
+ * rising density. Every planner should find paths of the same cost.
+ */
+void benchmark_bidirectional(int nrows, int ncols, int num_queries) {
+	double densities[4] = { 0.1, 0.2, 0.4, 0.6 };
+	for (double density : densities) {
+		bool** maze = create_clustered_maze(nrows, ncols, density);
+		if (maze == NULL) {
+			return;
+		}
+
+		// Starts in the top left quarter and goals in the bottom right one, so queries cross the map
+		vector<tuple<int, int, int, int>> queries;
+		for (int query = 0; query < num_queries; query++) {
+			int start_x = rand() % (nrows / 4), start_y = rand() % (ncols / 4);
+			int goal_x = nrows - 1 - (rand() % (nrows / 4)), goal_y = ncols - 1 - (rand() % (ncols / 4));
+			maze[start_x][start_y] = false;
+			maze[goal_x][goal_y] = false;
+			queries.push_back(make_tuple(start_x, start_y, goal_x, goal_y));
+		}
+
+		AStar heap_astar = AStar(maze, nrows, ncols);
+		AStar bucket_astar = AStar(maze, nrows, ncols);
+		bucket_astar.set_queue_type(QUEUE_BUCKET);
+		BidirectionalAStar bidirectional = BidirectionalAStar(maze, nrows, ncols);
+		BidirectionalAStar threaded = BidirectionalAStar(maze, nrows, ncols);
+		threaded.set_threaded(true);
+
+		long long heap_total = 0, bucket_total = 0, bidirectional_total = 0, threaded_total = 0;
+		long long heap_expansions = 0, bucket_expansions = 0, bidirectional_expansions = 0, threaded_expansions = 0;
+		int mismatches = 0, found = 0;
+		for (tuple<int, int, int, int> query : queries) {
+			int start_x = get<0>(query), start_y = get<1>(query), goal_x = get<2>(query), goal_y = get<3>(query);
+
+			auto start = high_resolution_clock::now();
+			vector<tuple<int, int>> heap_path = heap_astar.generate_path(start_x, start_y, goal_x, goal_y);
+			auto stop = high_resolution_clock::now();
+			heap_total += duration_cast<microseconds>(stop - start).count();
+			heap_expansions += heap_astar.get_expansions();
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> bucket_path = bucket_astar.generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			bucket_total += duration_cast<microseconds>(stop - start).count();
+			bucket_expansions += bucket_astar.get_expansions();
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> bidirectional_path = bidirectional.generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			bidirectional_total += duration_cast<microseconds>(stop - start).count();
+			bidirectional_expansions += bidirectional.get_expansions();
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> threaded_path = threaded.generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			threaded_total += duration_cast<microseconds>(stop - start).count();
+			threaded_expansions += threaded.get_expansions();
+
+			int cost = NodeGrid::get_path_cost(start_x, start_y, heap_path);
+			if ((cost != NodeGrid::get_path_cost(start_x, start_y, bucket_path)) ||
+				(cost != NodeGrid::get_path_cost(start_x, start_y, bidirectional_path)) ||
+				(cost != NodeGrid::get_path_cost(start_x, start_y, threaded_path))) {
+				mismatches++;
+			}
+			found += !heap_path.empty();
+		}
+
+		printf("Clustered density %.2f, %d queries (%d found):\n", density, num_queries, found);
+		printf("  AStar (binary heap)        %10lld us, %lld expansions\n", heap_total, heap_expansions);
+		printf("  AStar (bucket queue)       %10lld us, %lld expansions\n", bucket_total, bucket_expansions);
+		printf("  BidirectionalAStar         %10lld us, %lld expansions\n", bidirectional_total, bidirectional_expansions);
+		printf("  BidirectionalAStar, 2 threads %7lld us, %lld expansions\n", threaded_total, threaded_expansions);
+		printf("  %d path cost mismatches\n", mismatches);
+	}
+}
+
+
+/*
+ * Plans on a maze read from a tile map with read_tile_maze, over bounds that
+ * cut through tiles and a map with some tiles missing (which read as free).
+ * Checks the maze cell by cell against the map, then checks that
+ * BidirectionalAStar finds paths of the same cost as AStar on it.
+ */
+void benchmark_bidirectional_tile_map(int width, int height, double density, int num_queries) {
+	const unsigned int log2_w = 4;
+	const long tile_w = 1 << log2_w;
+	gmtry2i::vector2i origin(-40, -24);
+	maps2::map_buffer<log2_w, ocpncy::otile<log2_w>> map(origin);
+	for (long tile_y = 0; tile_y < height + tile_w; tile_y += tile_w) {
+		for (long tile_x = 0; tile_x < width + tile_w; tile_x += tile_w) {
+			// Leaving about one tile in eight out of the map
+			if ((rand() % 8) == 0) {
+				continue;
+			}
+			ocpncy::otile<log2_w> tile = ocpncy::otile<log2_w>();
+			for (int y = 0; y < tile_w; y++) {
+				for (int x = 0; x < tile_w; x++) {
+					if (rand() < density * RAND_MAX) {
+						ocpncy::put_occ(x, y, tile);
+					}
+				}
+			}
+			map.write(origin + gmtry2i::vector2i(tile_x, tile_y), &tile);
+		}
+	}
+
+	// Bounds that start and end partway through tiles
+	gmtry2i::vector2i corner = origin + gmtry2i::vector2i(5, 3);
+	gmtry2i::aligned_box2i bounds(corner, corner + gmtry2i::vector2i(width, height));
+	bool** maze = read_tile_maze(&map, bounds);
+	if (maze == NULL) {
+		return;
+	}
+	int cell_mismatches = 0;
+	for (long x = bounds.min.x; x < bounds.max.x; x++) {
+		for (long y = bounds.min.y; y < bounds.max.y; y++) {
+			gmtry2i::vector2i tile_origin = maps2::align_down(gmtry2i::vector2i(x, y), origin, log2_w);
+			const ocpncy::otile<log2_w>* tile = map.read(tile_origin);
+			bool occupied = (tile != NULL) && ocpncy::get_occ(x - tile_origin.x, y - tile_origin.y, *tile);
+			cell_mismatches += (maze[x - bounds.min.x][y - bounds.min.y] != occupied);
+		}
+	}
+
+	AStar astar = AStar(maze, width, height);
+	BidirectionalAStar bidirectional = BidirectionalAStar(maze, width, height);
+	long long astar_total = 0, bidirectional_total = 0;
+	int mismatches = 0, found = 0;
+	for (int query = 0; query < num_queries; query++) {
+		int start_x = rand() % width, start_y = rand() % height, goal_x = rand() % width, goal_y = rand() % height;
+		maze[start_x][start_y] = false;
+		maze[goal_x][goal_y] = false;
+		astar.update_occupancy_map(maze);
+		bidirectional.update_occupancy_map(maze);
+
+		auto start = high_resolution_clock::now();
+		vector<tuple<int, int>> astar_path = astar.generate_path(start_x, start_y, goal_x, goal_y);
+		auto stop = high_resolution_clock::now();
+		astar_total += duration_cast<microseconds>(stop - start).count();
+
+		start = high_resolution_clock::now();
+		vector<tuple<int, int>> bidirectional_path = bidirectional.generate_path(start_x, start_y, goal_x, goal_y);
+		stop = high_resolution_clock::now();
+		bidirectional_total += duration_cast<microseconds>(stop - start).count();
+
+		if ((astar_path.empty() != bidirectional_path.empty()) ||
+			(NodeGrid::get_path_cost(start_x, start_y, astar_path) != NodeGrid::get_path_cost(start_x, start_y, bidirectional_path))) {
+			mismatches++;
+		}
+		found += !astar_path.empty();
+	}
+
+	printf("Tile map %dx%d, density %.2f, %d queries (%d found):\n", width, height, density, num_queries, found);
+	printf("  %d maze cells differ from the map\n", cell_mismatches);
+	printf("  AStar                      %10lld us\n", astar_total);
+	printf("  BidirectionalAStar         %10lld us\n", bidirectional_total);
+	printf("  %d path cost mismatches\n", mismatches);
+	free_2d_arr((void**) maze);
+}
+
+/*
+ * Plans one batch of random queries with a new AStar per query (which copies
+ * the map every time), with one reused AStar, and with BatchPlanner on 1, 2,
+ * 4, ... worker threads up to the hardware's, printing the throughput of
+ * each. Paths should cost the same throughout.
+ */
+void benchmark_batch_planner(int nrows, int ncols, double density, int num_queries) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+
+	vector<path_query_t> queries;
+	for (int query = 0; query < num_queries; query++) {
+		path_query_t request = { rand() % nrows, rand() % ncols, rand() % nrows, rand() % ncols };
+		maze[request.start_x][request.start_y] = false;
+		maze[request.goal_x][request.goal_y] = false;
+		queries.push_back(request);
+	}
+
+	vector<int> costs;
+	auto start = high_resolution_clock::now();
+	for (path_query_t request : queries) {
+		AStar astar = AStar(maze, nrows, ncols, request.start_x, request.start_y, request.goal_x, request.goal_y);
+		costs.push_back(NodeGrid::get_path_cost(request.start_x, request.start_y, astar.generate_path()));
+	}
+	auto stop = high_resolution_clock::now();
+	long long fresh_us = duration_cast<microseconds>(stop - start).count();
+	printf("New AStar per query:       %10lld us, %8.1f queries/s, %zu bytes per planner\n", fresh_us,
+		num_queries * 1e6 / max(1LL, fresh_us), AStar(maze, nrows, ncols).get_node_map()->get_memory_usage());
+
+	AStar reused = AStar(maze, nrows, ncols);
+	reused.set_queue_type(QUEUE_BUCKET);
+	start = high_resolution_clock::now();
+	for (path_query_t request : queries) {
+		reused.generate_path(request.start_x, request.start_y, request.goal_x, request.goal_y);
+	}
+	stop = high_resolution_clock::now();
+	long long reused_us = duration_cast<microseconds>(stop - start).count();
+	printf("Reused AStar (buckets):    %10lld us, %8.1f queries/s\n", reused_us, num_queries * 1e6 / max(1LL, reused_us));
+
+	int max_threads = max(1, (int) thread::hardware_concurrency());
+	for (int num_threads = 1; ; num_threads = min(num_threads * 2, max_threads)) {
+		BatchPlanner planner = BatchPlanner(maze, nrows, ncols, num_threads);
+		start = high_resolution_clock::now();
+		vector<path_result_t> results = planner.plan(queries);
+		stop = high_resolution_clock::now();
+		long long batch_us = duration_cast<microseconds>(stop - start).count();
+
+		int mismatches = 0;
+		long long search_us = 0;
+		for (int query = 0; query < num_queries; query++) {
+			if (NodeGrid::get_path_cost(queries[query].start_x, queries[query].start_y, results[query].path) != costs[query]) {
+				mismatches++;
+			}
+			search_us += results[query].microseconds;
+		}
+		printf("BatchPlanner, %2d threads: %10lld us, %8.1f queries/s, %lld us searching, %d path cost mismatches\n",
+			num_threads, batch_us, num_queries * 1e6 / max(1LL, batch_us), search_us, mismatches);
+		printf("    %zu bytes for the map and the first worker, %zu bytes per other worker\n",
+			planner.get_node_map()->get_memory_usage(), NodeGrid(planner.get_node_map()).get_memory_usage());
+
+		if (num_threads == max_threads) {
+			break;
+		}
+	}
+}
+
+
+/*
+ * Scaling benchmark for ParallelAStar: one corner to corner query planned
+ * with AStar and then with 1, 2, 4, ... workers up to the hardware's threads.
+ * Every path should cost the same as AStar's.
+ */
+void benchmark_parallel_astar(int nrows, int ncols, double density) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	AStar astar = AStar(maze, nrows, ncols);
+	auto start = high_resolution_clock::now();
+	int astar_cost = NodeGrid::get_path_cost(0, 0, astar.generate_path());
+	auto stop = high_resolution_clock::now();
+	printf("AStar:                  %10lld us, path cost %d, %d expansions\n",
+		(long long) duration_cast<microseconds>(stop - start).count(), astar_cost, astar.get_expansions());
+
+	ParallelAStar parallel = ParallelAStar(maze, nrows, ncols);
+	int max_threads = max(1, (int) thread::hardware_concurrency());
+	for (int num_threads = 1; ; num_threads = min(num_threads * 2, max_threads)) {
+		parallel.set_num_threads(num_threads);
+		start = high_resolution_clock::now();
+		int cost = NodeGrid::get_path_cost(0, 0, parallel.generate_path());
+		stop = high_resolution_clock::now();
+		printf("ParallelAStar, %2d threads: %10lld us, path cost %d, %d expansions, %lld messages%s\n", num_threads,
+			(long long) duration_cast<microseconds>(stop - start).count(), cost, parallel.get_expansions(),
+			parallel.get_messages(), (cost == astar_cost) ? "" : " (COST MISMATCH)");
+
+		if (num_threads == max_threads) {
+			break;
+		}
+	}
+}
+
+
+/*
+ * Builds the cost field from the middle of the map with a DistanceField
+ * (single-threaded Dijkstra) and then with DeltaStepping for several
+ * thread counts and bucket widths, checking that every cell's cost matches.
+ * Meant for large maps such as 4096 x 4096.
+ */
+void benchmark_delta_stepping(int nrows, int ncols, double density) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	int source_x = nrows / 2, source_y = ncols / 2;
+	maze[source_x][source_y] = false;
+
+	auto start = high_resolution_clock::now();
+	DistanceField field = DistanceField(maze, nrows, ncols, source_x, source_y);
+	auto stop = high_resolution_clock::now();
+	printf("Dijkstra (DistanceField):         %10lld us\n", (long long) duration_cast<microseconds>(stop - start).count());
+
+	int max_threads = max(1, (int) thread::hardware_concurrency());
+	int deltas[3] = { STRAIGHT_COST, DIAGONAL_COST, 4 * DIAGONAL_COST };
+	for (int delta : deltas) {
+		for (int num_threads = 1; ; num_threads = min(num_threads * 2, max_threads)) {
+			start = high_resolution_clock::now();
+			DeltaStepping stepping = DeltaStepping(maze, nrows, ncols, source_x, source_y, num_threads, delta);
+			stop = high_resolution_clock::now();
+
+			int mismatches = 0;
+			for (int row = 0; row < nrows; row++) {
+				for (int col = 0; col < ncols; col++) {
+					if (stepping.get_cost_to_go(row, col) != field.get_cost_to_go(row, col)) {
+						mismatches++;
+					}
+				}
+			}
+			printf("DeltaStepping, delta %2d, %2d threads: %10lld us, %d phases, %d cost mismatches\n", delta, num_threads,
+				(long long) duration_cast<microseconds>(stop - start).count(), stepping.get_phases(), mismatches);
+
+			if (num_threads == max_threads) {
+				break;
+			}
+		}
+	}
+}
+
+
+/*
+ * Plans the same random far-apart queries on a clustered maze with plain
+ * AStar and with AStar on ALT landmarks, then frees and blocks a few small
+ * patches of cells, updates both and plans the queries again. Paths should
+ * cost the same before and after, with far fewer expansions on landmarks.
+ */
+void benchmark_landmarks(int nrows, int ncols, double density, int num_queries, int num_edits) {
+	bool** maze = create_clustered_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+
+	// Starts in the top left quarter and goals in the bottom right one, so queries cross the map
+	vector<tuple<int, int, int, int>> queries;
+	for (int query = 0; query < num_queries; query++) {
+		int start_x = rand() % (nrows / 4), start_y = rand() % (ncols / 4);
+		int goal_x = nrows - 1 - (rand() % (nrows / 4)), goal_y = ncols - 1 - (rand() % (ncols / 4));
+		maze[start_x][start_y] = false;
+		maze[goal_x][goal_y] = false;
+		queries.push_back(make_tuple(start_x, start_y, goal_x, goal_y));
+	}
+
+	AStar plain = AStar(maze, nrows, ncols);
+	AStar alt = AStar(maze, nrows, ncols);
+	alt.set_queue_type(QUEUE_BUCKET);
+	auto start = high_resolution_clock::now();
+	alt.set_landmarks(8);
+	auto stop = high_resolution_clock::now();
+	printf("%d landmarks built in %lld us (%d expansions)\n", alt.get_landmarks()->get_num_landmarks(),
+		(long long) duration_cast<microseconds>(stop - start).count(), alt.get_landmarks()->get_expansions());
+
+	for (int round = 0; round < 2; round++) {
+		long long plain_total = 0, alt_total = 0, plain_expansions = 0, alt_expansions = 0;
+		int mismatches = 0, found = 0;
+		for (tuple<int, int, int, int> query : queries) {
+			int start_x = get<0>(query), start_y = get<1>(query), goal_x = get<2>(query), goal_y = get<3>(query);
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> plain_path = plain.generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			plain_total += duration_cast<microseconds>(stop - start).count();
+			plain_expansions += plain.get_expansions();
+
+			start = high_resolution_clock::now();
+			vector<tuple<int, int>> alt_path = alt.generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			alt_total += duration_cast<microseconds>(stop - start).count();
+			alt_expansions += alt.get_expansions();
+
+			if ((plain_path.empty() != alt_path.empty()) ||
+				(NodeGrid::get_path_cost(start_x, start_y, plain_path) != NodeGrid::get_path_cost(start_x, start_y, alt_path))) {
+				mismatches++;
+			}
+			found += !plain_path.empty();
+		}
+
+		printf("%s %d queries (%d found):\n", (round == 0) ? "Before edits," : "After edits,", num_queries, found);
+		printf("  AStar (octile)    %10lld us, %lld expansions\n", plain_total, plain_expansions);
+		printf("  AStar (landmarks) %10lld us, %lld expansions\n", alt_total, alt_expansions);
+		printf("  %d path cost mismatches\n", mismatches);
+
+		if (round == 0) {
+			// Every edit flips a 3 x 3 patch, alternately clearing and filling it, away from the queries' ends
+			for (int edit = 0; edit < num_edits; edit++) {
+				int row = (nrows / 4) + 1 + (rand() % (nrows / 2 - 4)), col = (ncols / 4) + 1 + (rand() % (ncols / 2 - 4));
+				for (int d_row = 0; d_row < 3; d_row++) {
+					for (int d_col = 0; d_col < 3; d_col++) {
+						maze[row + d_row][col + d_col] = (edit % 2);
+					}
+				}
+			}
+			start = high_resolution_clock::now();
+			alt.update_occupancy_map(maze);
+			stop = high_resolution_clock::now();
+			plain.update_occupancy_map(maze);
+			printf("%d edits repaired in %lld us (%d expansions)\n", num_edits,
+				(long long) duration_cast<microseconds>(stop - start).count(), alt.get_landmarks()->get_expansions());
+		}
+	}
+}
+
+
+// Returns whether the straight line between two cells' centers passes through the inside of an occupied cell, by sampling it
+static bool crosses_obstacle(bool** maze, int x_0, int y_0, int x_1, int y_1) {
+	int samples = 64 * (abs(x_1 - x_0) + abs(y_1 - y_0) + 1);
+	for (int sample = 0; sample <= samples; sample++) {
+		double x = x_0 + 0.5 + ((double) (x_1 - x_0) * sample) / samples;
+		double y = y_0 + 0.5 + ((double) (y_1 - y_0) * sample) / samples;
+		if ((x != floor(x)) && (y != floor(y)) && maze[(int) x][(int) y]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Plans the same random queries with AStar, Theta* and Lazy Theta*, printing
+ * the total path length (in cells), waypoints, expansions, line of sight
+ * checks and time of each, and checking that every leg of the any-angle
+ * paths stays clear of obstacles.
+ */
+void benchmark_theta_star(int nrows, int ncols, double density, int num_queries) {
+	bool** maze = create_clustered_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+
+	AStar astar = AStar(maze, nrows, ncols);
+	ThetaStar theta = ThetaStar(maze, nrows, ncols);
+	theta.set_lazy(false);
+	ThetaStar lazy_theta = ThetaStar(maze, nrows, ncols);
+
+	long long times[3] = { 0, 0, 0 }, expansions[3] = { 0, 0, 0 }, waypoints[3] = { 0, 0, 0 }, sight_checks[3] = { 0, 0, 0 };
+	double lengths[3] = { 0, 0, 0 };
+	int blocked_legs = 0, mismatches = 0, found = 0;
+	for (int query = 0; query < num_queries; query++) {
+		int start_x = rand() % nrows, start_y = rand() % ncols, goal_x = rand() % nrows, goal_y = rand() % ncols;
+		maze[start_x][start_y] = false;
+		maze[goal_x][goal_y] = false;
+		astar.update_occupancy_map(maze);
+		theta.update_occupancy_map(maze);
+		lazy_theta.update_occupancy_map(maze);
+
+		vector<tuple<int, int>> paths[3];
+		auto start = high_resolution_clock::now();
+		paths[0] = astar.generate_path(start_x, start_y, goal_x, goal_y);
+		auto stop = high_resolution_clock::now();
+		times[0] += duration_cast<microseconds>(stop - start).count();
+		expansions[0] += astar.get_expansions();
+
+		ThetaStar* planners[2] = { &theta, &lazy_theta };
+		for (int planner = 0; planner < 2; planner++) {
+			start = high_resolution_clock::now();
+			paths[planner + 1] = planners[planner]->generate_path(start_x, start_y, goal_x, goal_y);
+			stop = high_resolution_clock::now();
+			times[planner + 1] += duration_cast<microseconds>(stop - start).count();
+			expansions[planner + 1] += planners[planner]->get_expansions();
+			sight_checks[planner + 1] += planners[planner]->get_sight_checks();
+		}
+
+		for (int planner = 0; planner < 3; planner++) {
+			lengths[planner] += NodeGrid::get_path_length(start_x, start_y, paths[planner]);
+			waypoints[planner] += paths[planner].size();
+			if (paths[planner].empty() != paths[0].empty()) {
+				mismatches++;
+			}
+		}
+		for (int planner = 1; planner < 3; planner++) {
+			int x = start_x, y = start_y;
+			for (tuple<int, int> waypoint : paths[planner]) {
+				blocked_legs += crosses_obstacle(maze, x, y, get<0>(waypoint), get<1>(waypoint));
+				x = get<0>(waypoint);
+				y = get<1>(waypoint);
+			}
+		}
+		found += !paths[0].empty();
+	}
+
+	const char* names[3] = { "AStar      ", "Theta*     ", "Lazy Theta*" };
+	printf("Clustered density %.2f, %d queries (%d found):\n", density, num_queries, found);
+	for (int planner = 0; planner < 3; planner++) {
+		printf("  %s %10lld us, length %10.1f, %8lld waypoints, %9lld expansions, %9lld sight checks\n", names[planner],
+			times[planner], lengths[planner], waypoints[planner], expansions[planner], sight_checks[planner]);
+	}
+	printf("  %d blocked legs, %d reachability mismatches\n", blocked_legs, mismatches);
+}
@@ -1,26 +1,28 @@
 // Imports
 #include "../header.hh"
+#include <queue>
+#include <functional>
 
 
 // Tests the heapify function
 void pq_heapify() {
 	printf("Testing heapify:\n");
 
-	node_t* test = (node_t*)malloc(sizeof(node_t) * 8);
-	node_t** test_ptrs = (node_t**)malloc(sizeof(node_t*) * 8);
+	int* test = (int*)malloc(sizeof(int) * 8);
+	pq_key_t* test_keys = (pq_key_t*)malloc(sizeof(pq_key_t) * 8);
 	for (int index = 0; index < 8; index++) {
-		int cost = 10 * (8 - index);
-		CNode::set_cost_and_occupancy(&test[index], cost, 0);
-		CNode::set_heuristic(&test[index], 0);
-		test_ptrs[index] = &test[index];
+		float cost = 10 * (8 - index);
+		test[index] = index;
+		test_keys[index] = { cost, cost };
 	}
 
-	NodePriorityQueue pq = NodePriorityQueue(8, test_ptrs);
+	NodePriorityQueue pq = NodePriorityQueue(8, test, test_keys);
 	pq.print_heap();
 
 	while (!pq.isEmpty()) {
-		node_t* ptr = pq.pop();
-		printf("Ptr (cost + heuristic) is: %d\n", CNode::get_cost(ptr) + CNode::get_heuristic(ptr));
+		pq_key_t key = pq.top_key();
+		int node = pq.pop();
+		printf("Node %d (cost + heuristic) is: %.0f\n", node, key.k1);
 	}
 }
 
@@ -28,30 +30,25 @@ void pq_heapify() {
 void pq_add() {
 	printf("Testing add:\n");
 
-	node_t* test = (node_t*)malloc(sizeof(node_t) * 5);
-	node_t** test_ptrs = (node_t**)malloc(sizeof(node_t*) * 5);
+	int* test = (int*)malloc(sizeof(int) * 5);
+	pq_key_t* test_keys = (pq_key_t*)malloc(sizeof(pq_key_t) * 5);
 	for (int index = 0; index < 5; index++) {
-		int cost = 10 * (5 - index);
-		CNode::set_cost_and_occupancy(&test[index], cost, 0);
-		CNode::set_heuristic(&test[index], 0);
-		test_ptrs[index] = &test[index];
+		float cost = 10 * (5 - index);
+		test[index] = index;
+		test_keys[index] = { cost, cost };
 	}
 
-	NodePriorityQueue pq = NodePriorityQueue(5, test_ptrs);
+	NodePriorityQueue pq = NodePriorityQueue(5, test, test_keys);
 	pq.print_heap();
 
-	test = (node_t*)malloc(sizeof(node_t));
-	CNode::initialize_node(test, 0, false, 0);
-	pq.push(test);
-
-	test = (node_t*)malloc(sizeof(node_t));
-	CNode::initialize_node(test, 100, false, 0);
-	pq.push(test);
+	pq.push(5, { 0, 0 });
+	pq.push(6, { 100, 100 });
 	pq.print_heap();
 
 	while (!pq.isEmpty()) {
-		node_t* ptr = pq.pop();
-		printf("Ptr (cost + heuristic) is: %d\n", CNode::get_cost(ptr) + CNode::get_heuristic(ptr));
+		pq_key_t key = pq.top_key();
+		int node = pq.pop();
+		printf("Node %d (cost + heuristic) is: %.0f\n", node, key.k1);
 	}
 }
 
@@ -60,30 +57,28 @@ void pq_add() {
 void pq_resize() {
 	printf("Testing resize:\n");
 
-	node_t* test = (node_t*)malloc(sizeof(node_t) * 8);
-	node_t** test_ptrs = (node_t**)malloc(sizeof(node_t*) * 8);
+	int* test = (int*)malloc(sizeof(int) * 8);
+	pq_key_t* test_keys = (pq_key_t*)malloc(sizeof(pq_key_t) * 8);
 	for (int index = 0; index < 8; index++) {
-		int cost = 10 * (8 - index);
-		CNode::set_cost_and_occupancy(&test[index], cost, 0);
-		CNode::set_heuristic(&test[index], 0);
-		test_ptrs[index] = &test[index];
+		float cost = 10 * (8 - index);
+		test[index] = index;
+		test_keys[index] = { cost, cost };
 	}
 
-	NodePriorityQueue pq = NodePriorityQueue(8, test_ptrs);
+	NodePriorityQueue pq = NodePriorityQueue(8, test, test_keys);
 	pq.print_heap();
 
 	for (int i = 0; i < 15; i++) {
 		printf("Adding: %d\n", i);
-		test = (node_t*)malloc(sizeof(node_t));
-		CNode::initialize_node(test, i, false, 0);
-		pq.push(test);
+		pq.push(8 + i, { (float) i, (float) i });
 		pq.print_heap();
 	}
 
 	
 	while (!pq.isEmpty()) {
-		node_t* ptr = pq.pop();
-		printf("Ptr (cost + heuristic) is: %d\n", CNode::get_cost(ptr) + CNode::get_heuristic(ptr));
+		pq_key_t key = pq.top_key();
+		int node = pq.pop();
+		printf("Node %d (cost + heuristic) is: %.0f\n", node, key.k1);
 	}
 }
 
@@ -91,30 +86,199 @@ void pq_resize() {
 void pq_pop() {
 	printf("Testing pop:\n");
 
-	node_t* test = (node_t*)malloc(sizeof(node_t) * 8);
-	node_t** test_ptrs = (node_t**)malloc(sizeof(node_t*) * 8);
+	int* test = (int*)malloc(sizeof(int) * 8);
+	pq_key_t* test_keys = (pq_key_t*)malloc(sizeof(pq_key_t) * 8);
 	for (int index = 0; index < 8; index++) {
-		int cost = 10 * (8 - index);
-		CNode::set_cost_and_occupancy(&test[index], cost, 0);
-		CNode::set_heuristic(&test[index], 0);
-		test_ptrs[index] = &test[index];
+		float cost = 10 * (8 - index);
+		test[index] = index;
+		test_keys[index] = { cost, cost };
 	}
 
-	NodePriorityQueue pq = NodePriorityQueue(8, test_ptrs);
+	NodePriorityQueue pq = NodePriorityQueue(8, test, test_keys);
 	pq.print_heap();
 
 	while (!pq.isEmpty()) {
-		node_t* ptr = pq.pop();
-		printf("Ptr (cost + heuristic) is: %d\n", CNode::get_cost(ptr) + CNode::get_heuristic(ptr));
+		pq_key_t key = pq.top_key();
+		int node = pq.pop();
+		printf("Node %d (cost + heuristic) is: %.0f\n", node, key.k1);
 		pq.print_heap();
 	}
 }
 
 
+// Tests decrease-key and remove-by-element
+void pq_update() {
+	printf("Testing update and remove:\n");
+
+	NodePriorityQueue pq = NodePriorityQueue(8);
+	for (int index = 0; index < 8; index++) {
+		float cost = 10 * (8 - index);
+		pq.push(index, { cost, cost });
+	}
+	pq.print_heap();
+
+	// Moving the largest element to the front
+	pq.decrease_key(0, { 2, 2 });
+	printf("Min after decrease (expecting 2): %.0f\n", pq.top_key().k1);
+
+	// Moving the smallest element to the back
+	pq.update_key(7, { 100, 100 });
+	printf("Contains updated element (expecting 1): %d\n", pq.contains(7));
+
+	// Removing from the middle
+	pq.remove(4);
+	printf("Contains removed element (expecting 0): %d\n", pq.contains(4));
+	printf("Size after remove (expecting 7): %d\n", pq.get_size());
+
+	while (!pq.isEmpty()) {
+		pq_key_t key = pq.top_key();
+		int node = pq.pop();
+		printf("Node %d cost is: %.0f\n", node, key.k1);
+	}
+}
+
+
+// Tests that the bucket queue pops random keys in order, including keys that force the ring to grow
+void bq_order() {
+	printf("Testing bucket queue order:\n");
+
+	BucketQueue bq = BucketQueue(1000);
+	int out_of_order = 0, popped = 0, last_key = -1;
+	for (int index = 0; index < 1000; index++) {
+		bq.push(index, rand() % ((index < 500) ? 50 : 5000));
+	}
+	while (!bq.isEmpty()) {
+		int key = bq.top_key();
+		bq.pop();
+		if (key < last_key) {
+			out_of_order++;
+		}
+		last_key = key;
+		popped++;
+	}
+	printf("Popped %d (expecting 1000), out of order (expecting 0): %d\n", popped, out_of_order);
+}
+
+// Tests updating, removing and clearing bucket queue entries
+void bq_update() {
+	printf("Testing bucket queue update:\n");
+
+	BucketQueue bq = BucketQueue(8);
+	for (int index = 0; index < 8; index++) {
+		bq.push(index, 10 + (2 * index));
+	}
+	bq.decrease_key(7, { 4, 4 });
+	bq.push(3, 30);
+	bq.remove(5);
+	printf("Contains removed element (expecting 0): %d\n", bq.contains(5));
+	printf("Size after remove (expecting 7): %d\n", bq.get_size());
+
+	while (!bq.isEmpty()) {
+		int key = bq.top_key();
+		int node = bq.pop();
+		printf("Node %d cost is: %d\n", node, key);
+	}
+
+	bq.push(2, 6);
+	bq.clear();
+	printf("Size after clear (expecting 0): %d, contains (expecting 0): %d\n", bq.get_size(), bq.contains(2));
+}
+
+
 // Runs all the pq tests
 void test_pq() {
 	pq_heapify();
 	pq_add();
 	pq_pop();
 	pq_resize();
-}
\ No newline at end of file
+	pq_update();
+	bq_order();
+	bq_update();
+}
+
+
+/*
+ * Dijkstra with a std::priority_queue, which can't update keys, so improved
+ * nodes are pushed again and stale entries are skipped when popped. Returns
+ * the goal's cost (max_cost if unreachable).
+ */
+static int std_pq_dijkstra(NodeGrid* grid, int start, int goal) {
+	priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> open;
+	grid->begin_search();
+	grid->visit(start);
+	grid->g[start] = 0;
+	open.push(make_pair(0, start));
+	while (!open.empty()) {
+		pair<int, int> top = open.top();
+		open.pop();
+		int of_interest = top.second;
+		if (top.first > grid->g[of_interest]) {
+			continue;
+		}
+		if (of_interest == goal) {
+			return top.first;
+		}
+		for (neighbor_t next : grid->neighbors(of_interest)) {
+			int new_cost = top.first + next.cost;
+			grid->visit(next.index);
+			if (new_cost < grid->g[next.index]) {
+				grid->g[next.index] = new_cost;
+				open.push(make_pair(new_cost, next.index));
+			}
+		}
+	}
+	return max_cost;
+}
+
+/*
+ * Times Dijkstra with the binary heap, the bucket queue and std::priority_queue,
+ * and AStar with the binary heap and the bucket queue, corner to corner on one
+ * maze (e.g. the 30 x 30 test_AStar maze and larger ones).
+ */
+void benchmark_queues(int nrows, int ncols, double density) {
+	bool** maze = create_maze(nrows, ncols, density);
+	if (maze == NULL) {
+		return;
+	}
+	maze[0][0] = false;
+	maze[nrows - 1][ncols - 1] = false;
+
+	Dijkstra dijkstra = Dijkstra(maze, nrows, ncols);
+	auto start = high_resolution_clock::now();
+	int heap_cost = NodeGrid::get_path_cost(0, 0, dijkstra.generate_path());
+	auto stop = high_resolution_clock::now();
+	long long heap_time = duration_cast<microseconds>(stop - start).count();
+
+	dijkstra.set_queue_type(QUEUE_BUCKET);
+	start = high_resolution_clock::now();
+	int bucket_cost = NodeGrid::get_path_cost(0, 0, dijkstra.generate_path());
+	stop = high_resolution_clock::now();
+	long long bucket_time = duration_cast<microseconds>(stop - start).count();
+
+	NodeGrid* grid = dijkstra.get_node_map();
+	start = high_resolution_clock::now();
+	int std_cost = std_pq_dijkstra(grid, grid->index(0, 0), grid->index(nrows - 1, ncols - 1));
+	stop = high_resolution_clock::now();
+	long long std_time = duration_cast<microseconds>(stop - start).count();
+
+	printf("%d x %d Dijkstra: NodePriorityQueue %lld us (cost %d), BucketQueue %lld us (cost %d), std::priority_queue %lld us (cost %d)\n",
+		nrows, ncols, heap_time, heap_cost, bucket_time, bucket_cost, std_time,
+		(std_cost == max_cost) ? 0 : std_cost);
+
+	AStar astar = AStar(maze, nrows, ncols);
+	start = high_resolution_clock::now();
+	heap_cost = NodeGrid::get_path_cost(0, 0, astar.generate_path());
+	stop = high_resolution_clock::now();
+	heap_time = duration_cast<microseconds>(stop - start).count();
+	int heap_expansions = astar.get_expansions();
+
+	astar.set_queue_type(QUEUE_BUCKET);
+	start = high_resolution_clock::now();
+	bucket_cost = NodeGrid::get_path_cost(0, 0, astar.generate_path());
+	stop = high_resolution_clock::now();
+	bucket_time = duration_cast<microseconds>(stop - start).count();
+
+	printf("%d x %d AStar: NodePriorityQueue %lld us (cost %d, %d expansions), BucketQueue %lld us (cost %d, %d expansions)\n",
+		nrows, ncols, heap_time, heap_cost, heap_expansions, bucket_time, bucket_cost,
+		astar.get_expansions());
+}
@@ -0,0 +1,27 @@
+// Imports
+#include "../header.hh"
+
+#define OUTPUT_FILEPATH (std::string("resources/output/"))
+#include "pthfnd_tests.hpp"
+
+
+// Runs the tests of the tile planners (pthfnd), returning the total number of mismatches they found
+int test_pthfnd() {
+	int num_mismatches = 0;
+	num_mismatches += pf_tests::bit_jps_test0();
+	num_mismatches += pf_tests::bit_jps_test1();
+	num_mismatches += pf_tests::wavefront_test0();
+	num_mismatches += pf_tests::wavefront_test1();
+	num_mismatches += pf_tests::hpa_star_test0();
+	num_mismatches += pf_tests::hpa_star_test1();
+	num_mismatches += pf_tests::tile_a_star_test0();
+	num_mismatches += pf_tests::tile_a_star_test1();
+	num_mismatches += pf_tests::tile_a_star_test2();
+	num_mismatches += pf_tests::tile_a_star_test3();
+	num_mismatches += pf_tests::path_smoothing_test0();
+	num_mismatches += pf_tests::path_smoothing_test1();
+	num_mismatches += pf_tests::state_lattice_test0();
+	num_mismatches += pf_tests::state_lattice_test1();
+	printf("Tile planner mismatches: %d\n", num_mismatches);
+	return num_mismatches;
+}
@@ -0,0 +1,646 @@
+#pragma once
+
+#include "../pthfnd/bit_jps.hpp"
+#include "../pthfnd/wavefront.hpp"
+#include "../pthfnd/hpa_star.hpp"
+#include "../pthfnd/tile_a_star.hpp"
+#include "../pthfnd/path_smoothing.hpp"
+#include "../pthfnd/state_lattice.hpp"
+#include "../maps2/maps2_streams.hpp"
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <cstdio>
+
+#ifndef OUTPUT_FILEPATH 
+#	define OUTPUT_FILEPATH (std::string(""))
+#endif
+
+namespace pf_tests {
+	typedef maps2::map_buffer<4, ocpncy::otile<4>> bmap_buffer4;
+
+	// Fills a width x height block of tiles starting at origin with random occupancies (roughly density occupied)
+	void fill_random_map(bmap_buffer4& map, const gmtry2i::vector2i& origin, long width, long height, double density) {
+		for (long ty = 0; ty < height; ty += 16) for (long tx = 0; tx < width; tx += 16) {
+			ocpncy::otile<4> tile = ocpncy::otile<4>();
+			for (int y = 0; y < 16; y++) for (int x = 0; x < 16; x++)
+				if (std::rand() < density * RAND_MAX) ocpncy::put_occ(x, y, tile);
+			map.write(origin + gmtry2i::vector2i(tx, ty), &tile);
+		}
+	}
+
+	// Returns the number of 8-connected steps from start to finish found by breadth-first search (-1 if unreachable)
+	long bfs_steps(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish) {
+		gmtry2i::aligned_box2i bounds = grid.get_bounds();
+		long width = grid.get_width(), height = grid.get_height();
+		std::vector<long> steps(width * height, -1);
+		std::queue<gmtry2i::vector2i> frontier;
+		if (grid.get_occ(start) || grid.get_occ(finish)) return -1;
+		steps[(start.x - bounds.min.x) + (start.y - bounds.min.y) * width] = 0;
+		frontier.push(start);
+		while (!frontier.empty()) {
+			gmtry2i::vector2i p = frontier.front();
+			frontier.pop();
+			long p_steps = steps[(p.x - bounds.min.x) + (p.y - bounds.min.y) * width];
+			if (p.x == finish.x && p.y == finish.y) return p_steps;
+			for (int dx = -1; dx <= 1; dx++) for (int dy = -1; dy <= 1; dy++) {
+				gmtry2i::vector2i n = p + gmtry2i::vector2i(dx, dy);
+				if (grid.get_occ(n)) continue;
+				long& n_steps = steps[(n.x - bounds.min.x) + (n.y - bounds.min.y) * width];
+				if (n_steps < 0) {
+					n_steps = p_steps + 1;
+					frontier.push(n);
+				}
+			}
+		}
+		return -1;
+	}
+
+	// Returns the octile cost of the cheapest path from start to finish found by Dijkstra's search (-1 if unreachable)
+	long octile_cost(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish) {
+		gmtry2i::aligned_box2i bounds = grid.get_bounds();
+		long width = grid.get_width(), height = grid.get_height();
+		std::vector<long> costs(width * height, -1);
+		std::priority_queue<std::pair<long, long>, std::vector<std::pair<long, long>>, std::greater<std::pair<long, long>>> frontier;
+		if (grid.get_occ(start) || grid.get_occ(finish)) return -1;
+		costs[(start.x - bounds.min.x) + (start.y - bounds.min.y) * width] = 0;
+		frontier.push({ 0, (start.x - bounds.min.x) + (start.y - bounds.min.y) * width });
+		while (!frontier.empty()) {
+			std::pair<long, long> top = frontier.top();
+			frontier.pop();
+			if (top.first != costs[top.second]) continue;
+			gmtry2i::vector2i p(bounds.min.x + top.second % width, bounds.min.y + top.second / width);
+			if (p.x == finish.x && p.y == finish.y) return top.first;
+			for (int dx = -1; dx <= 1; dx++) for (int dy = -1; dy <= 1; dy++) {
+				gmtry2i::vector2i n = p + gmtry2i::vector2i(dx, dy);
+				if ((dx == 0 && dy == 0) || grid.get_occ(n)) continue;
+				long n_index = (n.x - bounds.min.x) + (n.y - bounds.min.y) * width;
+				long n_cost = top.first + ((dx && dy) ? DIAGONAL_COST : STRAIGHT_COST);
+				if (costs[n_index] < 0 || n_cost < costs[n_index]) {
+					costs[n_index] = n_cost;
+					frontier.push({ n_cost, n_index });
+				}
+			}
+		}
+		return -1;
+	}
+
+	// Returns the octile cost of a path's steps from start
+	long path_cost(const gmtry2i::vector2i& start, const std::vector<gmtry2i::vector2i>& path) {
+		long cost = 0;
+		gmtry2i::vector2i last = start;
+		for (const gmtry2i::vector2i& p : path) {
+			cost += (p.x != last.x && p.y != last.y) ? DIAGONAL_COST : STRAIGHT_COST;
+			last = p;
+		}
+		return cost;
+	}
+
+	// Returns whether every step of the path moves to an adjacent free cell, ending at finish
+	bool path_is_valid(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& start, const gmtry2i::vector2i& finish,
+	                   const std::vector<gmtry2i::vector2i>& path) {
+		gmtry2i::vector2i last = start;
+		for (const gmtry2i::vector2i& p : path) {
+			if (grid.get_occ(p) || std::abs(p.x - last.x) > 1 || std::abs(p.y - last.y) > 1) return false;
+			last = p;
+		}
+		return path.empty() || (last.x == finish.x && last.y == finish.y);
+	}
+
+	// Checks the bit-parallel JPS against breadth-first search on random tile maps
+	int bit_jps_test0() {
+		std::cout << "BIT JPS TEST 0" << std::endl;
+		std::srand(7);
+		int num_mismatches = 0, num_trials = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 12), height = 16 * (1 + std::rand() % 12);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.1 + 0.03 * (map_num % 10));
+			pthfnd::bit_grid grid(&map, gmtry2i::aligned_box2i(origin, origin + gmtry2i::vector2i(width, height)));
+			pthfnd::bit_jps planner(grid);
+			for (int trial = 0; trial < 20; trial++) {
+				gmtry2i::vector2i start = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				long expected = bfs_steps(grid, start, finish);
+				std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+				long found = (expected == 0) ? 0 : (path.empty() ? -1 : static_cast<long>(path.size()));
+				if (found != expected || !path_is_valid(grid, start, finish, path)) num_mismatches++;
+				num_trials++;
+			}
+		}
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Times the bit-parallel JPS on a large, sparsely occupied map
+	int bit_jps_test1() {
+		std::cout << "BIT JPS TEST 1" << std::endl;
+		std::srand(11);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 1024, height = 1024;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		pthfnd::bit_grid grid(&map, gmtry2i::aligned_box2i(origin, origin + gmtry2i::vector2i(width, height)));
+		grid.set_occ(origin, false);
+		grid.set_occ(origin + gmtry2i::vector2i(width - 1, height - 1), false);
+		pthfnd::bit_jps planner(grid);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		std::vector<gmtry2i::vector2i> path = planner.generate_path(origin, origin + gmtry2i::vector2i(width - 1, height - 1));
+		auto stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "Path length: " << path.size() << ", expansions: " << planner.get_expansions() << ", time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		return 0;
+	}
+
+	// Checks the wavefront's step counts against breadth-first search on random tile maps
+	int wavefront_test0() {
+		std::cout << "WAVEFRONT TEST 0" << std::endl;
+		std::srand(13);
+		int num_mismatches = 0, num_trials = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 12), height = 16 * (1 + std::rand() % 12);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.1 + 0.03 * (map_num % 10));
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::wavefront<4> wave(&map, bounds);
+			gmtry2i::vector2i source = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+			wave.compute(source);
+			for (int trial = 0; trial < 20; trial++) {
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				long expected = bfs_steps(grid, source, finish);
+				unsigned int steps = wave.get_steps(finish);
+				long found = (steps == pthfnd::UNREACHED) ? -1 : static_cast<long>(steps);
+				if (found != expected) num_mismatches++;
+				num_trials++;
+			}
+		}
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Times the wavefront and breadth-first search across a large, sparsely occupied map
+	int wavefront_test1() {
+		std::cout << "WAVEFRONT TEST 1" << std::endl;
+		std::srand(11);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 1024, height = 1024;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+		pthfnd::bit_grid grid(&map, bounds);
+		grid.set_occ(origin, false);
+		grid.set_occ(origin + gmtry2i::vector2i(width - 1, height - 1), false);
+		ocpncy::otile<4> first_tile = *map.read(origin), last_tile = *map.read(origin + gmtry2i::vector2i(width - 16, height - 16));
+		ocpncy::set_occ(0, 0, first_tile, false);
+		ocpncy::set_occ(15, 15, last_tile, false);
+		pthfnd::wavefront<4> wave(&map, bounds);
+		wave.update_tile(origin, first_tile);
+		wave.update_tile(origin + gmtry2i::vector2i(width - 16, height - 16), last_tile);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		wave.compute(origin);
+		auto stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "Wavefront steps: " << wave.get_steps(origin + gmtry2i::vector2i(width - 1, height - 1)) <<
+			", waves: " << wave.get_num_steps() << ", time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+
+		start_time = std::chrono::high_resolution_clock::now();
+		long steps = bfs_steps(grid, origin, origin + gmtry2i::vector2i(width - 1, height - 1));
+		stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "BFS steps: " << steps << ", time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		return 0;
+	}
+
+	// Checks HPA* paths against breadth-first search on random tile maps, rewriting a tile between queries
+	int hpa_star_test0() {
+		std::cout << "HPA* TEST 0" << std::endl;
+		std::srand(17);
+		int num_mismatches = 0, num_trials = 0;
+		long total_steps = 0, total_path = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 12), height = 16 * (1 + std::rand() % 12);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.1 + 0.03 * (map_num % 10));
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::hpa_star<4> planner(&map, bounds);
+			for (int trial = 0; trial < 20; trial++) {
+				if (trial % 5 == 4) {
+					gmtry2i::vector2i tile_origin = origin + gmtry2i::vector2i(16 * (std::rand() % (width / 16)), 16 * (std::rand() % (height / 16)));
+					ocpncy::otile<4> tile = ocpncy::otile<4>();
+					for (int y = 0; y < 16; y++) for (int x = 0; x < 16; x++)
+						if (std::rand() < 0.4 * RAND_MAX) ocpncy::put_occ(x, y, tile);
+					grid.update_tile(tile_origin, tile);
+					planner.update_tile(tile_origin, tile);
+				}
+				gmtry2i::vector2i start = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				long expected = bfs_steps(grid, start, finish);
+				std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+				long found = (expected == 0) ? 0 : (path.empty() ? -1 : static_cast<long>(path.size()));
+				// Paths may be longer than the shortest, but have to exist whenever one does
+				if ((found < 0) != (expected < 0) || found < expected || !path_is_valid(grid, start, finish, path))
+					num_mismatches++;
+				else if (expected > 0) {
+					total_steps += expected;
+					total_path += found;
+				}
+				num_trials++;
+			}
+		}
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << ", path length / shortest: " <<
+			static_cast<double>(total_path) / total_steps << std::endl;
+		return num_mismatches;
+	}
+
+	// Times HPA* and the bit-parallel JPS across a large, sparsely occupied map
+	int hpa_star_test1() {
+		std::cout << "HPA* TEST 1" << std::endl;
+		std::srand(11);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 1024, height = 1024;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+		ocpncy::otile<4> first_tile = *map.read(origin), last_tile = *map.read(origin + gmtry2i::vector2i(width - 16, height - 16));
+		ocpncy::set_occ(0, 0, first_tile, false);
+		ocpncy::set_occ(15, 15, last_tile, false);
+		map.write(origin, &first_tile);
+		map.write(origin + gmtry2i::vector2i(width - 16, height - 16), &last_tile);
+		pthfnd::bit_grid grid(&map, bounds);
+		pthfnd::bit_jps jps(grid);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+		pthfnd::hpa_star<4> planner(&map, bounds);
+		auto stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "Entrances: " << planner.get_num_entrances() << ", build time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+
+		for (int query = 0; query < 2; query++) {
+			start_time = std::chrono::high_resolution_clock::now();
+			std::vector<gmtry2i::vector2i> path = planner.generate_path(origin, origin + gmtry2i::vector2i(width - 1, height - 1));
+			stop_time = std::chrono::high_resolution_clock::now();
+			std::cout << "HPA* path length: " << path.size() << ", expansions: " << planner.get_expansions() << ", time: " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		}
+
+		start_time = std::chrono::high_resolution_clock::now();
+		std::vector<gmtry2i::vector2i> path = jps.generate_path(origin, origin + gmtry2i::vector2i(width - 1, height - 1));
+		stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "JPS path length: " << path.size() << ", time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		return 0;
+	}
+
+	// Checks the tile A* against Dijkstra's search on random tile maps, rewriting a tile between searches
+	int tile_a_star_test0() {
+		std::cout << "TILE A* TEST 0" << std::endl;
+		std::srand(19);
+		int num_mismatches = 0, num_trials = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 12), height = 16 * (1 + std::rand() % 12);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.1 + 0.03 * (map_num % 10));
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::tile_a_star<4> planner(&map, bounds);
+			for (int trial = 0; trial < 20; trial++) {
+				if (trial % 5 == 4) {
+					gmtry2i::vector2i tile_origin = origin + gmtry2i::vector2i(16 * (std::rand() % (width / 16)), 16 * (std::rand() % (height / 16)));
+					ocpncy::otile<4> tile = ocpncy::otile<4>();
+					for (int y = 0; y < 16; y++) for (int x = 0; x < 16; x++)
+						if (std::rand() < 0.4 * RAND_MAX) ocpncy::put_occ(x, y, tile);
+					map.write(tile_origin, &tile);
+					grid.update_tile(tile_origin, tile);
+					planner.update_tile(tile_origin, tile);
+				}
+				gmtry2i::vector2i start = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				long expected = octile_cost(grid, start, finish);
+				std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+				long found = (expected == 0) ? 0 : (path.empty() ? -1 : path_cost(start, path));
+				if (found != expected || !path_is_valid(grid, start, finish, path)) num_mismatches++;
+				num_trials++;
+			}
+		}
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Plans a short and a long path on a large map, showing how many tiles the search state covers
+	int tile_a_star_test1() {
+		std::cout << "TILE A* TEST 1" << std::endl;
+		std::srand(11);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 2048, height = 2048;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+		gmtry2i::vector2i queries[2][2] = {
+			{ gmtry2i::vector2i(1000, 1000), gmtry2i::vector2i(1100, 1060) },
+			{ gmtry2i::vector2i(10, 10), gmtry2i::vector2i(width - 10, height - 10) }
+		};
+		for (int query = 0; query < 2; query++) {
+			pthfnd::tile_a_star<4> planner(&map, bounds);
+			auto start_time = std::chrono::high_resolution_clock::now();
+			std::vector<gmtry2i::vector2i> path = planner.generate_path(queries[query][0], queries[query][1]);
+			auto stop_time = std::chrono::high_resolution_clock::now();
+			std::cout << "Path length: " << path.size() << ", expansions: " << planner.get_expansions() <<
+				", blocks: " << planner.get_num_blocks() << " / " << (width / 16) * (height / 16) <<
+				", memory: " << planner.get_memory_usage() / 1024 << " KiB, time: " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		}
+		return 0;
+	}
+
+	// Checks the paged tile A* against Dijkstra's search while holding as few blocks as it can
+	int tile_a_star_test2() {
+		std::cout << "TILE A* TEST 2" << std::endl;
+		std::srand(23);
+		int num_mismatches = 0, num_trials = 0;
+		for (int map_num = 0; map_num < 10; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (4 + std::rand() % 9), height = 16 * (4 + std::rand() % 9);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.1 + 0.03 * map_num);
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::tile_a_star<4> planner(&map, bounds, 0, OUTPUT_FILEPATH + "pthfnd_spill");
+			for (int trial = 0; trial < 20; trial++) {
+				gmtry2i::vector2i start = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				long expected = octile_cost(grid, start, finish);
+				std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+				long found = (expected == 0) ? 0 : (path.empty() ? -1 : path_cost(start, path));
+				if (found != expected || !path_is_valid(grid, start, finish, path)) num_mismatches++;
+				num_trials++;
+			}
+		}
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Plans across a map file with a bounded number of resident blocks, comparing against the unbounded planner
+	int tile_a_star_test3() {
+		std::cout << "TILE A* TEST 3" << std::endl;
+		std::srand(29);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 1024, height = 1024;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		std::string map_file_name = OUTPUT_FILEPATH + "pthfnd_map";
+		std::remove(map_file_name.c_str());
+		maps2::map_fstream<4, ocpncy::otile<4>> map_file(map_file_name, origin);
+		for (long y = 0; y < height; y += 16) for (long x = 0; x < width; x += 16)
+			map_file.write(origin + gmtry2i::vector2i(x, y), map.read(origin + gmtry2i::vector2i(x, y)));
+		gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+		gmtry2i::vector2i start(10, 10), finish(width - 10, height - 10);
+
+		pthfnd::tile_a_star<4> planner(&map_file, bounds);
+		std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+		std::cout << "Unbounded path cost: " << path_cost(start, path) << ", resident: " << planner.get_num_resident() <<
+			", memory: " << planner.get_memory_usage() / 1024 << " KiB" << std::endl;
+
+		pthfnd::tile_a_star<4> paged_planner(&map_file, bounds, 64, OUTPUT_FILEPATH + "pthfnd_spill");
+		auto start_time = std::chrono::high_resolution_clock::now();
+		std::vector<gmtry2i::vector2i> paged_path = paged_planner.generate_path(start, finish);
+		auto stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "Paged path cost: " << path_cost(start, paged_path) << ", resident: " << paged_planner.get_num_resident() <<
+			", loads: " << paged_planner.get_num_loads() << ", spills: " << paged_planner.get_num_spills() <<
+			", memory: " << paged_planner.get_memory_usage() / 1024 << " KiB, time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		return path_cost(start, paged_path) != path_cost(start, path);
+	}
+
+	// Returns whether the line between two cells' centers stays out of every occupied cell, by sampling it
+	bool sampled_sight(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& a, const gmtry2i::vector2i& b) {
+		long samples = 64 * (std::abs(b.x - a.x) + std::abs(b.y - a.y) + 1);
+		for (long sample = 0; sample <= samples; sample++) {
+			double x = a.x + 0.5 + static_cast<double>(b.x - a.x) * sample / samples;
+			double y = a.y + 0.5 + static_cast<double>(b.y - a.y) * sample / samples;
+			if (x != std::floor(x) && y != std::floor(y) &&
+			    grid.get_occ(gmtry2i::vector2i(static_cast<long>(std::floor(x)), static_cast<long>(std::floor(y))))) return false;
+		}
+		return true;
+	}
+
+	// Checks the tile line of sight against sampled lines, and that smoothed JPS paths only take legs in sight
+	int path_smoothing_test0() {
+		std::cout << "PATH SMOOTHING TEST 0" << std::endl;
+		std::srand(31);
+		int num_mismatches = 0, num_trials = 0;
+		size_t num_cells = 0, num_waypoints = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 12), height = 16 * (1 + std::rand() % 12);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.05 + 0.02 * (map_num % 10));
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::bit_jps planner(grid);
+			pthfnd::tile_sight<4> sight(&map);
+			for (int trial = 0; trial < 20; trial++) {
+				gmtry2i::vector2i a = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i b = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				if (sight.line_of_sight(a, b) != sampled_sight(grid, a, b)) num_mismatches++;
+				std::vector<gmtry2i::vector2i> path = planner.generate_path(a, b);
+				std::vector<gmtry2i::vector2i> waypoints = pthfnd::smooth_path(sight, a, path, 1.0);
+				gmtry2i::vector2i last = a;
+				for (const gmtry2i::vector2i& p : waypoints) {
+					if (!sampled_sight(grid, last, p)) num_mismatches++;
+					last = p;
+				}
+				if (!path.empty() && (waypoints.empty() || last.x != b.x || last.y != b.y)) num_mismatches++;
+				num_cells += path.size();
+				num_waypoints += waypoints.size();
+				num_trials++;
+			}
+		}
+		std::cout << "Cells: " << num_cells << ", waypoints: " << num_waypoints << std::endl;
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Smooths a long JPS path on a large map, with each tolerance
+	int path_smoothing_test1() {
+		std::cout << "PATH SMOOTHING TEST 1" << std::endl;
+		std::srand(37);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 2048, height = 2048;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		pthfnd::bit_grid grid(&map, gmtry2i::aligned_box2i(origin, origin + gmtry2i::vector2i(width, height)));
+		gmtry2i::vector2i start(10, 10), finish(width - 10, height - 300);
+		grid.set_occ(start, false);
+		grid.set_occ(finish, false);
+		pthfnd::bit_jps planner(grid);
+		std::vector<gmtry2i::vector2i> path = planner.generate_path(start, finish);
+		std::cout << "Path cells: " << path.size() << std::endl;
+		double tolerances[3] = { 0.0, 1.0, 4.0 };
+		for (double tolerance : tolerances) {
+			pthfnd::tile_sight<4> sight(&map);
+			auto start_time = std::chrono::high_resolution_clock::now();
+			std::vector<gmtry2i::vector2i> waypoints = pthfnd::smooth_path(sight, start, path, tolerance);
+			auto stop_time = std::chrono::high_resolution_clock::now();
+			std::cout << "Tolerance " << tolerance << ": " << waypoints.size() << " waypoints, " << sight.get_minis_tested() <<
+				" minis tested, time: " << std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() <<
+				" us" << std::endl;
+		}
+		return 0;
+	}
+
+	// Returns whether every cell a primitive's center line passes through is free, by sampling it
+	bool sampled_primitive_clear(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& from, const pthfnd::motion_primitive& p) {
+		double p1x = pthfnd::LATTICE_DIRECTIONS[p.start_heading][0], p1y = pthfnd::LATTICE_DIRECTIONS[p.start_heading][1];
+		if (p.start_heading == p.end_heading) {
+			p1x /= 2;
+			p1y /= 2;
+		}
+		for (int sample = 0; sample <= 4096; sample++) {
+			double t = sample / 4096.0;
+			double x = 2 * (1 - t) * t * p1x + t * t * p.dx, y = 2 * (1 - t) * t * p1y + t * t * p.dy;
+			gmtry2i::vector2i cell(from.x + static_cast<long>(std::floor(x + 0.5)), from.y + static_cast<long>(std::floor(y + 0.5)));
+			if (grid.get_occ(cell)) return false;
+		}
+		return true;
+	}
+
+	/*
+	* Returns the cost of the cheapest lattice path from start to finish found by Dijkstra's algorithm, checking each
+	*	primitive's footprint cell by cell (pthfnd::UNREACHED if there's none)
+	*/
+	unsigned int lattice_dijkstra_cost(const pthfnd::bit_grid& grid, const gmtry2i::vector2i& start, unsigned int start_heading,
+	                                   const gmtry2i::vector2i& finish) {
+		gmtry2i::aligned_box2i bounds = grid.get_bounds();
+		long width = grid.get_width(), height = grid.get_height();
+		if (grid.get_occ(start) || grid.get_occ(finish)) return pthfnd::UNREACHED;
+		std::vector<unsigned int> costs(width * height * pthfnd::LATTICE_HEADINGS, pthfnd::UNREACHED);
+		typedef std::pair<unsigned int, long> queued_state;
+		std::priority_queue<queued_state, std::vector<queued_state>, std::greater<queued_state>> open;
+		long start_state = ((start.y - bounds.min.y) * width + (start.x - bounds.min.x)) * pthfnd::LATTICE_HEADINGS + start_heading;
+		costs[start_state] = 0;
+		open.push({ 0, start_state });
+		while (!open.empty()) {
+			queued_state top = open.top();
+			open.pop();
+			if (top.first != costs[top.second]) continue;
+			unsigned int heading = top.second % pthfnd::LATTICE_HEADINGS;
+			gmtry2i::vector2i p = bounds.min + gmtry2i::vector2i((top.second / pthfnd::LATTICE_HEADINGS) % width,
+			                                                     (top.second / pthfnd::LATTICE_HEADINGS) / width);
+			if (p.x == finish.x && p.y == finish.y) return top.first;
+			for (unsigned int i = 0; i < pthfnd::LATTICE_PRIMITIVES_PER_HEADING; i++) {
+				const pthfnd::motion_primitive& primitive = pthfnd::LATTICE_PRIMITIVES[heading * pthfnd::LATTICE_PRIMITIVES_PER_HEADING + i];
+				bool clear = true;
+				for (long bit = 0; bit < 64 && clear; bit++) if ((primitive.footprint >> bit) & 1)
+					clear = !grid.get_occ(p + gmtry2i::vector2i((bit & 7) - pthfnd::LATTICE_REACH, (bit >> 3) - pthfnd::LATTICE_REACH));
+				if (!clear) continue;
+				gmtry2i::vector2i next = p + gmtry2i::vector2i(primitive.dx, primitive.dy);
+				long next_state = ((next.y - bounds.min.y) * width + (next.x - bounds.min.x)) * pthfnd::LATTICE_HEADINGS + primitive.end_heading;
+				if (top.first + primitive.cost >= costs[next_state]) continue;
+				costs[next_state] = top.first + primitive.cost;
+				open.push({ costs[next_state], next_state });
+			}
+		}
+		return pthfnd::UNREACHED;
+	}
+
+	/*
+	* Checks the state lattice's path costs against Dijkstra's algorithm on random tile maps, rewriting a tile between
+	*	searches, and that each path's primitives chain together and only sweep free cells
+	*/
+	int state_lattice_test0() {
+		std::cout << "STATE LATTICE TEST 0" << std::endl;
+		std::srand(41);
+		int num_mismatches = 0, num_trials = 0, num_found = 0;
+		for (int map_num = 0; map_num < 20; map_num++) {
+			gmtry2i::vector2i origin(-48, -32);
+			long width = 16 * (1 + std::rand() % 6), height = 16 * (1 + std::rand() % 6);
+			bmap_buffer4 map(origin);
+			fill_random_map(map, origin, width, height, 0.02 + 0.02 * (map_num % 10));
+			gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+			pthfnd::bit_grid grid(&map, bounds);
+			pthfnd::state_lattice<4> planner(&map, bounds);
+			for (int trial = 0; trial < 20; trial++) {
+				if (trial % 5 == 4) {
+					gmtry2i::vector2i tile_origin = origin + gmtry2i::vector2i(16 * (std::rand() % (width / 16)), 16 * (std::rand() % (height / 16)));
+					ocpncy::otile<4> tile = ocpncy::otile<4>();
+					for (int y = 0; y < 16; y++) for (int x = 0; x < 16; x++)
+						if (std::rand() < 0.2 * RAND_MAX) ocpncy::put_occ(x, y, tile);
+					map.write(tile_origin, &tile);
+					grid.update_tile(tile_origin, tile);
+					planner.update_tile(tile_origin, tile);
+				}
+				gmtry2i::vector2i start = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				gmtry2i::vector2i finish = origin + gmtry2i::vector2i(std::rand() % width, std::rand() % height);
+				unsigned int start_heading = std::rand() % pthfnd::LATTICE_HEADINGS;
+				unsigned int expected = lattice_dijkstra_cost(grid, start, start_heading, finish);
+				std::vector<pthfnd::lattice_state> path = planner.generate_path(start, start_heading, finish);
+				if (planner.get_cost() != expected) num_mismatches++;
+				else if (expected != pthfnd::UNREACHED) {
+					gmtry2i::vector2i last = start;
+					unsigned int heading = start_heading, cost = 0;
+					bool valid = true;
+					for (const pthfnd::lattice_state& state : path) {
+						const pthfnd::motion_primitive& p = pthfnd::LATTICE_PRIMITIVES[state.primitive];
+						valid = valid && p.start_heading == heading && p.end_heading == state.heading &&
+						        state.p.x == last.x + p.dx && state.p.y == last.y + p.dy && sampled_primitive_clear(grid, last, p);
+						cost += p.cost;
+						last = state.p;
+						heading = state.heading;
+					}
+					if (!valid || cost != expected || last.x != finish.x || last.y != finish.y) num_mismatches++;
+					num_found++;
+				}
+				num_trials++;
+			}
+		}
+		std::cout << "Paths found: " << num_found << std::endl;
+		std::cout << "Mismatches: " << num_mismatches << " / " << num_trials << std::endl;
+		return num_mismatches;
+	}
+
+	// Times the state lattice on a large map over a short, a medium and a long query
+	int state_lattice_test1() {
+		std::cout << "STATE LATTICE TEST 1" << std::endl;
+		std::srand(43);
+		gmtry2i::vector2i origin(0, 0);
+		long width = 1024, height = 1024;
+		bmap_buffer4 map(origin);
+		fill_random_map(map, origin, width, height, 0.05);
+		gmtry2i::aligned_box2i bounds(origin, origin + gmtry2i::vector2i(width, height));
+		// The planners share one table, built the first time one is made, so build another copy just to time it
+		auto start_time = std::chrono::high_resolution_clock::now();
+		std::vector<unsigned int> table = pthfnd::make_lattice_heuristic_table();
+		auto stop_time = std::chrono::high_resolution_clock::now();
+		std::cout << "Heuristic table: " << table.size() * sizeof(unsigned int) / 1024 << " KiB, time: " <<
+			std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		pthfnd::state_lattice<4> planner(&map, bounds);
+		gmtry2i::vector2i queries[3][2] = {
+			{ gmtry2i::vector2i(500, 500), gmtry2i::vector2i(530, 480) },
+			{ gmtry2i::vector2i(400, 400), gmtry2i::vector2i(520, 460) },
+			{ gmtry2i::vector2i(100, 100), gmtry2i::vector2i(600, 400) }
+		};
+		for (int query = 0; query < 3; query++) {
+			start_time = std::chrono::high_resolution_clock::now();
+			std::vector<pthfnd::lattice_state> path = planner.generate_path(queries[query][0], 8, queries[query][1]);
+			stop_time = std::chrono::high_resolution_clock::now();
+			std::cout << "Path states: " << path.size() << ", cost: " << planner.get_cost() << ", expansions: " <<
+				planner.get_expansions() << ", blocks: " << planner.get_num_blocks() << " / " << (width / 16) * (height / 16) <<
+				", memory: " << planner.get_memory_usage() / 1024 << " KiB, time: " <<
+				std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() << " us" << std::endl;
+		}
+		return 0;
+	}
+}
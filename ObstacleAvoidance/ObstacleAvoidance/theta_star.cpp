@@ -0,0 +1,176 @@
+// Includes
+#include "header.hh"
+
+
+// Defining ThetaStar Class
+// Straight-line distance between two nodes in STRAIGHT_COST units, rounded to the nearest integer
+inline int ThetaStar::get_distance(int from, int to) {
+	int d_x = grid.row_of(to) - grid.row_of(from), d_y = grid.col_of(to) - grid.col_of(from);
+	return (int) lroundf(STRAIGHT_COST * sqrtf((float) ((d_x * d_x) + (d_y * d_y))));
+}
+
+// Checks line of sight between two nodes, counting the check
+inline bool ThetaStar::has_sight(int from, int to) {
+	sight_checks++;
+	return grid.line_of_sight(from, to);
+}
+
+/*
+ * Offers a neighbor of the expanded node a path through the expanded node's
+ * parent, straight from the parent if it can see the neighbor (path 2) and
+ * otherwise through the expanded node itself (path 1). Lazy Theta* always
+ * takes path 2 and leaves the check to set_vertex.
+ */
+void ThetaStar::relax(int of_interest, int neighbor) {
+	int parent = grid.parents[of_interest];
+	int from = of_interest;
+	if ((parent != -1) && (lazy || has_sight(parent, neighbor))) {
+		from = parent;
+	}
+
+	int new_cost = grid.g[from] + get_distance(from, neighbor);
+	grid.visit(neighbor);
+	if (new_cost < grid.g[neighbor]) {
+		if (grid.g[neighbor] == max_cost) {
+			grid.heuristic[neighbor] = (float) get_distance(neighbor, grid.index(goal_x, goal_y));
+		}
+		grid.g[neighbor] = new_cost;
+		grid.parents[neighbor] = from;
+		pq.push(neighbor, { grid.heuristic[neighbor] + new_cost, (float) new_cost });
+	}
+}
+
+/*
+ * Lazy Theta*: a node that turns out not to see the parent it was given
+ * takes the best path through one of its expanded neighbors instead. The
+ * neighbor it was reached from is always one of them.
+ */
+void ThetaStar::set_vertex(int of_interest) {
+	int parent = grid.parents[of_interest];
+	if ((parent == -1) || has_sight(parent, of_interest)) {
+		return;
+	}
+
+	grid.g[of_interest] = max_cost;
+	for (neighbor_t next : grid.neighbors(of_interest)) {
+		if (closed[next.index] == search_id) {
+			int new_cost = grid.g[next.index] + next.cost;
+			if (new_cost < grid.g[of_interest]) {
+				grid.g[of_interest] = new_cost;
+				grid.parents[of_interest] = next.index;
+			}
+		}
+	}
+}
+
+// Performs necessary computations, stores them in the grid, & returns if path was found
+bool ThetaStar::compute() {
+	// Nodes left over from the last search go stale instead of being reset
+	grid.begin_search();
+	pq.clear();
+	expansions = 0;
+	sight_checks = 0;
+	search_id++;
+	if (search_id == 0) {
+		fill(closed.begin(), closed.end(), 0);
+		search_id = 1;
+	}
+
+	int start = grid.index(start_x, start_y), goal = grid.index(goal_x, goal_y);
+	grid.visit(start);
+	grid.g[start] = 0;
+	grid.heuristic[start] = (float) get_distance(start, goal);
+	pq.push(start, { grid.heuristic[start], 0 });
+
+	while (!pq.isEmpty()) {
+		int of_interest = pq.pop();
+		expansions++;
+		if (lazy) {
+			set_vertex(of_interest);
+		}
+
+		// Checking if destination reached
+		if (of_interest == goal) {
+			return true;
+		}
+
+		closed[of_interest] = search_id;
+		for (neighbor_t next : grid.neighbors(of_interest)) {
+			if (closed[next.index] != search_id) {
+				relax(of_interest, next.index);
+			}
+		}
+	}
+
+	return false;
+}
+
+// constructors
+ThetaStar::ThetaStar(bool** occ_matrix, int rows, int cols) :
+	ThetaStar(occ_matrix, rows, cols, 0, 0, rows - 1, cols - 1) {}
+
+ThetaStar::ThetaStar(bool** occ_matrix, int rows, int cols, int start_x, int start_y, int goal_x, int goal_y) :
+	grid(rows, cols, occ_matrix), closed(grid.get_num_nodes(), 0), pq(grid.get_num_nodes()) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	this->rows = rows;
+	this->cols = cols;
+	this->expansions = 0;
+	this->sight_checks = 0;
+	this->lazy = true;
+	this->search_id = 0;
+}
+
+// Returns the node grid assosiated with this instance
+NodeGrid* ThetaStar::get_node_map() {
+	return &this->grid;
+}
+
+// Returns the number of nodes popped off the pq during the last search
+int ThetaStar::get_expansions() {
+	return this->expansions;
+}
+
+// Returns the number of line of sight checks made during the last search
+int ThetaStar::get_sight_checks() {
+	return this->sight_checks;
+}
+
+// Selects Lazy Theta* (the default) or Theta*, which checks line of sight for every neighbor it relaxes
+void ThetaStar::set_lazy(bool lazy) {
+	this->lazy = lazy;
+}
+
+/*
+ * Searches from the start to the goal and if a path exists, returns its
+ * waypoints (start --> finish, excluding the start like NodeGrid::trace_path).
+ * Each waypoint can see the next, so flying straight between them is safe.
+ */
+vector<tuple<int, int>> ThetaStar::generate_path() {
+	vector<tuple<int, int>> path;
+	if (compute()) {
+		path = grid.trace_path(grid.index(goal_x, goal_y));
+	}
+	return path;
+}
+
+// Plans between a new start and goal, reusing this instance's grid and pq
+vector<tuple<int, int>> ThetaStar::generate_path(int start_x, int start_y, int goal_x, int goal_y) {
+	this->start_x = start_x;
+	this->start_y = start_y;
+	this->goal_x = goal_x;
+	this->goal_y = goal_y;
+	return generate_path();
+}
+
+// Updates the occupancy map and returns true, since any change can open or close a line of sight
+bool ThetaStar::update_occupancy_map(bool** occupancy_map) {
+	for (int row = 0; row < this->rows; row++) {
+		for (int col = 0; col < this->cols; col++) {
+			grid.set_occupancy(grid.index(row, col), occupancy_map[row][col]);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,49 @@
+// Prevents multiple definitions
+#pragma once
+
+// Includes
+#include "header.hh"
+#include "maps2/tilemaps2.hpp"
+#include "ocpncy/occupancy.hpp"
+
+
+/*
+ * Reads the part of a tile map inside bounds into an occupancy matrix that
+ * any of the grid planners can take, with row = x - bounds.min.x and
+ * col = y - bounds.min.y. Each tile is read once, and space with no tile is
+ * unoccupied. Returns NULL if the matrix can't be allocated.
+ */
+template <unsigned int log2_w>
+bool** read_tile_maze(maps2::map_istream<ocpncy::otile<log2_w>>* map, const gmtry2i::aligned_box2i& bounds) {
+	int nrows = bounds.max.x - bounds.min.x, ncols = bounds.max.y - bounds.min.y;
+	bool** maze = (bool**) allocate_2d_arr(nrows, ncols, sizeof(bool));
+	if (maze == NULL) {
+		fprintf(stderr, "Problem allocating memory for the maze.\n");
+		return NULL;
+	}
+	for (int row = 0; row < nrows; row++) {
+		memset(maze[row], 0, sizeof(bool) * ncols);
+	}
+
+	const long tile_w = 1 << log2_w;
+	gmtry2i::aligned_box2i tiles = maps2::align_out(bounds, map->get_bounds().min, log2_w);
+	for (long tile_x = tiles.min.x; tile_x < tiles.max.x; tile_x += tile_w) {
+		for (long tile_y = tiles.min.y; tile_y < tiles.max.y; tile_y += tile_w) {
+			const ocpncy::otile<log2_w>* tile = map->read(gmtry2i::vector2i(tile_x, tile_y));
+			if (tile == NULL) {
+				continue;
+			}
+
+			// Copying the tile's cells that fall inside the bounds
+			long min_x = max(tile_x, bounds.min.x), max_x = min(tile_x + tile_w, bounds.max.x);
+			long min_y = max(tile_y, bounds.min.y), max_y = min(tile_y + tile_w, bounds.max.y);
+			for (long x = min_x; x < max_x; x++) {
+				for (long y = min_y; y < max_y; y++) {
+					maze[x - bounds.min.x][y - bounds.min.y] = ocpncy::get_occ(x - tile_x, y - tile_y, *tile);
+				}
+			}
+		}
+	}
+
+	return maze;
+}
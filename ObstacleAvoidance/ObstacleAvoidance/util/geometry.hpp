@@ -2,6 +2,9 @@
 
 #include <string>
 #include <cmath>
+#include <algorithm>
+#include <utility>
+#include <concepts>
 
 const float PI = 3.14159265F;
 
@@ -421,6 +424,40 @@ namespace gmtry2i {
 		else scanline_rasterize<1, T>(l, out);
 	}
 
+	// Rounds a fraction down (the denominator must be positive)
+	inline long long floor_div(long long num, long long den) {
+		return (num >= 0) ? num / den : -((-num + den - 1) / den);
+	}
+
+	// Whether run_occupied(first_x, last_x, y) is true for a run of cells from (first_x, y) to (last_x, y)
+	template <typename T>
+	concept tests_runs2i = requires(T t, long first_x, long last_x, long y) {
+		{ t(first_x, last_x, y) } -> std::convertible_to<bool>;
+	};
+
+	// Returns whether the line between the centers of cells a and b stays clear of the inside of every occupied cell
+	// The line crosses a contiguous run of cells in each row it spans, and each run is given to run_occupied
+	// Passing exactly through the corner between two occupied cells is allowed
+	// Runs are found in exact integer arithmetic by working in half cells, where the centers sit on odd coordinates
+	template <tests_runs2i T>
+	bool runs_clear(vector2i a, vector2i b, T run_occupied) {
+		if (a.y > b.y) std::swap(a, b);
+		long long dx = b.x - a.x, dy = b.y - a.y;
+		if (dy == 0) return !run_occupied(std::min(a.x, b.x), std::max(a.x, b.x), a.y);
+		for (long y = a.y; y <= b.y; y++) {
+			// Part of the line inside the row, in half cells from the first center (0 to 2 dy)
+			long long enter = std::max(2LL * y, 2LL * a.y + 1) - (2LL * a.y + 1);
+			long long leave = std::min(2LL * y + 2, 2LL * b.y + 1) - (2LL * a.y + 1);
+			// x of the line at either end, as a fraction over 2 dy
+			long long low = (2LL * a.x + 1) * dy + enter * dx, high = (2LL * a.x + 1) * dy + leave * dx;
+			if (low > high) std::swap(low, high);
+			long first_x = static_cast<long>(floor_div(low, 2 * dy));
+			long last_x = (low == high) ? first_x : static_cast<long>(floor_div(high + 2 * dy - 1, 2 * dy)) - 1;
+			if (run_occupied(first_x, last_x, y)) return false;
+		}
+		return true;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////
 	//    BOX INTERSECTION ABSTRACTION                                                                //
 	////////////////////////////////////////////////////////////////////////////////////////////////////